@@ -0,0 +1,326 @@
+#include <hana23/batch_executor.hpp>
+#include <hana23/job_graph.hpp>
+#include <hana23/move_only_function.hpp>
+#include <hana23/pipeline.hpp>
+#include <hana23/thread_pool.hpp>
+#if defined(__linux__) && defined(__x86_64__)
+#include <hana23/fiber_scheduler.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double nanoseconds_since(bench_clock::time_point start) {
+	return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+}
+
+// throughput of a pipeline with 1 to 8 trivial stages, each stage on its own thread and as tasks
+// of a thread_pool, elements are ints and every stage adds one, so the cost is the hand-over
+
+static double run_pipeline(size_t stages, long elements, hana23::thread_pool * pool) {
+	long sum = 0;
+	auto builder = hana23::pipeline_builder<long>{};
+
+	for (size_t i = 0; i != stages; ++i) {
+		builder = std::move(builder).stage<long>([](long && x, hana23::emitter<long> & emit) { emit(x + 1); });
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	{
+		auto counting = [&sum](long && x) { sum += x; };
+		auto p = pool ? std::move(builder).sink(counting, *pool) : std::move(builder).sink(counting);
+
+		for (long i = 0; i != elements; ++i) {
+			p.push(i);
+		}
+		p.wait();
+	}
+
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	assert(sum == elements * (elements - 1) / 2 + elements * static_cast<long>(stages));
+	(void)sum;
+	return static_cast<double>(elements) / elapsed.count() / 1e6;
+}
+
+static void bench_pipeline(hana23::thread_pool & pool, long elements) {
+	printf("pipeline: %ld elements\n", elements);
+	printf("stages  threads [M/s]  pool [M/s]\n");
+
+	for (size_t stages = 1; stages <= 8; ++stages) {
+		const double threaded = run_pipeline(stages, elements, nullptr);
+		const double pooled = run_pipeline(stages, elements, &pool);
+		printf("%6zu  %13.2f  %10.2f\n", stages, threaded, pooled);
+	}
+}
+
+// scheduling overhead of job_graph with no-op jobs: a fan-out (one root preceding all other jobs,
+// they are posted and stolen), a chain (every job continues inline with its only successor) and
+// layers of 1000 jobs each preceded by 4 jobs of the previous layer (so edges dominate), the first
+// run includes the compaction, the later ones only reset counters
+
+static void report_job_graph(const char * shape, hana23::job_graph & graph, hana23::thread_pool & pool) {
+	auto start = bench_clock::now();
+	graph.run(pool);
+	const double first = nanoseconds_since(start);
+
+	constexpr int runs = 5;
+	start = bench_clock::now();
+	for (int i = 0; i != runs; ++i) {
+		graph.run(pool);
+	}
+	const double later = nanoseconds_since(start) / runs;
+
+	const double nodes = static_cast<double>(graph.size());
+	const double edges = static_cast<double>(graph.edge_count());
+	printf("%-8s  %9zu  %9zu  %14.2f  %14.2f  %13.2f  %13.2f\n", shape, graph.size(), graph.edge_count(), first / nodes, first / edges, later / nodes, later / edges);
+}
+
+static void bench_job_graph(hana23::thread_pool & pool, size_t jobs) {
+	printf("job_graph: no-op jobs, ns per node/edge\n");
+	printf("shape         nodes      edges  first run/node  first run/edge  next run/node  next run/edge\n");
+
+	{
+		hana23::job_graph graph;
+		const auto root = graph.add([] { });
+		for (size_t i = 1; i != jobs; ++i) {
+			graph.precede(root, graph.add([] { }));
+		}
+		report_job_graph("fan-out", graph, pool);
+	}
+
+	{
+		hana23::job_graph graph;
+		auto previous = graph.add([] { });
+		for (size_t i = 1; i != jobs; ++i) {
+			const auto next = graph.add([] { });
+			graph.precede(previous, next);
+			previous = next;
+		}
+		report_job_graph("chain", graph, pool);
+	}
+
+	{
+		constexpr size_t width = 1000;
+		hana23::job_graph graph;
+		for (size_t i = 0; i != jobs; ++i) {
+			const auto job = graph.add([] { });
+			if (i >= width) {
+				const size_t layer = i / width * width - width;
+				for (size_t k = 0; k != 4; ++k) {
+					graph.precede(static_cast<hana23::job_graph::job_id>(layer + (i + k * 251) % width), job);
+				}
+			}
+		}
+		report_job_graph("layers", graph, pool);
+	}
+}
+
+#if defined(__linux__) && defined(__x86_64__)
+// fiber switch (yield to the other ready fiber through the scheduler) against two threads handing a
+// token over through an atomic (futex wait/notify), and fiber creation (spawn, run and finish of an
+// empty fiber, with fresh and recycled stacks) against creating and joining std::thread
+
+static double thread_handoff(int rounds) {
+	std::atomic<int> turn{0};
+
+	auto player = [&turn, rounds](int self) {
+		for (int i = 0; i != rounds; ++i) {
+			for (int current; (current = turn.load(std::memory_order_acquire)) != self;) {
+				turn.wait(current, std::memory_order_acquire);
+			}
+			turn.store(1 - self, std::memory_order_release);
+			turn.notify_one();
+		}
+	};
+
+	const auto start = bench_clock::now();
+	std::thread other{player, 1};
+	player(0);
+	other.join();
+	return nanoseconds_since(start) / (2.0 * rounds);
+}
+
+static void bench_fibers() {
+	constexpr int rounds = 1000000;
+	constexpr int count = 10000;
+
+	hana23::fiber_scheduler scheduler;
+	for (int i = 0; i != 2; ++i) {
+		scheduler.spawn([&scheduler] {
+			for (int j = 0; j != rounds; ++j) {
+				scheduler.yield();
+			}
+		});
+	}
+
+	auto start = bench_clock::now();
+	scheduler.run();
+	const double fiber_switch = nanoseconds_since(start) / (2.0 * rounds);
+
+	start = bench_clock::now();
+	{
+		hana23::fiber_scheduler fresh;
+		for (int i = 0; i != count; ++i) {
+			fresh.spawn([] { });
+		}
+		fresh.run();
+	}
+	const double fiber_fresh = nanoseconds_since(start) / count;
+
+	// stacks of the previous batch are reused
+	start = bench_clock::now();
+	for (int i = 0; i != count; ++i) {
+		scheduler.spawn([] { });
+		scheduler.run();
+	}
+	const double fiber_recycled = nanoseconds_since(start) / count;
+
+	start = bench_clock::now();
+	for (int i = 0; i != count; ++i) {
+		std::thread{[] { }}.join();
+	}
+	const double thread_create = nanoseconds_since(start) / count;
+
+	printf("fibers: ns per operation\n");
+	printf("switch (fiber yield)          %10.2f\n", fiber_switch);
+	printf("switch (thread handoff)       %10.2f\n", thread_handoff(rounds / 10));
+	printf("create (fiber, fresh stack)   %10.2f\n", fiber_fresh);
+	printf("create (fiber, reused stack)  %10.2f\n", fiber_recycled);
+	printf("create (std::thread)          %10.2f\n", thread_create);
+}
+#endif
+
+// the same random mix of 8 task types drained by batch_executor (grouped by type, direct calls) and
+// from a FIFO vector of move_only_function (indirect call to a random target per task), each type
+// loops a different number of times, so FIFO order makes the loop exit unpredictable too, run only
+// one of them under `perf stat -e branch-misses` to compare (tasks are one pointer, so the FIFO side
+// stores them inline and doesn't allocate)
+
+static uint64_t checksum = 0;
+
+template <int Kind> struct mixed_task {
+	uint64_t * total;
+
+	void operator()() && {
+		for (int i = 0; i <= Kind; ++i) {
+			*total = *total * 31 + static_cast<uint64_t>(Kind + i);
+		}
+	}
+};
+
+template <typename Post> static void post_mixed(std::vector<uint8_t> & kinds, uint64_t & total, Post && post) {
+	for (const uint8_t kind: kinds) {
+		switch (kind) {
+		case 0: post(mixed_task<0>{&total}); break;
+		case 1: post(mixed_task<1>{&total}); break;
+		case 2: post(mixed_task<2>{&total}); break;
+		case 3: post(mixed_task<3>{&total}); break;
+		case 4: post(mixed_task<4>{&total}); break;
+		case 5: post(mixed_task<5>{&total}); break;
+		case 6: post(mixed_task<6>{&total}); break;
+		default: post(mixed_task<7>{&total}); break;
+		}
+	}
+}
+
+// returns ns per drained task
+static double drain_grouped(std::vector<uint8_t> & kinds, int rounds) {
+	hana23::batch_executor ex;
+	uint64_t total = 0;
+	double elapsed = 0;
+
+	for (int r = 0; r != rounds; ++r) {
+		post_mixed(kinds, total, [&ex](auto && task) { ex.post(std::move(task)); });
+
+		const auto start = bench_clock::now();
+		ex.run();
+		elapsed += nanoseconds_since(start);
+	}
+
+	checksum += total;
+	return elapsed / (static_cast<double>(kinds.size()) * rounds);
+}
+
+static double drain_fifo(std::vector<uint8_t> & kinds, int rounds) {
+	std::vector<hana23::move_only_function<void() &&>> queue;
+	queue.reserve(kinds.size());
+	uint64_t total = 0;
+	double elapsed = 0;
+
+	for (int r = 0; r != rounds; ++r) {
+		post_mixed(kinds, total, [&queue](auto && task) { queue.emplace_back(std::move(task)); });
+
+		const auto start = bench_clock::now();
+		for (auto & task: queue) {
+			std::move(task)();
+		}
+		queue.clear();
+		elapsed += nanoseconds_since(start);
+	}
+
+	checksum += total;
+	return elapsed / (static_cast<double>(kinds.size()) * rounds);
+}
+
+// mode is "grouped", "fifo" or empty for both
+static void bench_batch_executor(std::string_view mode) {
+	constexpr size_t tasks = 1000000;
+	constexpr int rounds = 10;
+
+	std::vector<uint8_t> kinds(tasks);
+	uint32_t state = 0x9E3779B9u;
+	for (uint8_t & kind: kinds) {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		kind = static_cast<uint8_t>(state % 8);
+	}
+
+	printf("batch_executor: %zu tasks of 8 types in random order, ns per task\n", tasks);
+	if (mode.empty() || mode == "grouped") {
+		printf("grouped  %6.2f\n", drain_grouped(kinds, rounds));
+	}
+	if (mode.empty() || mode == "fifo") {
+		printf("fifo     %6.2f\n", drain_fifo(kinds, rounds));
+	}
+	printf("(checksum %llu)\n", static_cast<unsigned long long>(checksum));
+}
+
+// `hana-bench [section [argument]]` runs everything or one section: `pipeline [elements]`,
+// `job_graph`, `fibers`, `batch [grouped|fifo]`
+int main(int argc, char ** argv) {
+	const std::string_view section = argc > 1 ? argv[1] : "";
+	const std::string_view argument = argc > 2 ? argv[2] : "";
+	const auto selected = [section](std::string_view name) { return section.empty() || section == name; };
+
+	hana23::thread_pool pool;
+	printf("%zu pool threads\n", pool.size());
+
+	if (selected("pipeline")) {
+		printf("\n");
+		bench_pipeline(pool, argument.empty() ? 1000000 : std::atol(argument.data()));
+	}
+	if (selected("job_graph")) {
+		printf("\n");
+		bench_job_graph(pool, 1000000);
+	}
+#if defined(__linux__) && defined(__x86_64__)
+	if (selected("fibers")) {
+		printf("\n");
+		bench_fibers();
+	}
+#endif
+	if (selected("batch")) {
+		printf("\n");
+		bench_batch_executor(argument);
+	}
+}
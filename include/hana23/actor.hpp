@@ -0,0 +1,140 @@
+#ifndef HANA23_ACTOR_HPP
+#define HANA23_ACTOR_HPP
+
+#include "executor.hpp"
+#include "move_only_function.hpp"
+#include "utility/bounded_queue.hpp"
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+
+namespace hana23 {
+
+// state owned by a bounded mailbox of messages, messages are processed one at a time on the executor
+// and each activation processes up to BatchSize of them before yielding the worker back
+
+// messages are stored inline in the mailbox slots, so messages fitting into move_only_function's
+// buffer don't allocate at all
+
+// actor must outlive all its pending messages (`wait_idle` waits for them), destruction waits only for
+// the activation currently running on the executor to return, messages left at destruction are
+// destroyed without invoking
+
+template <typename State, executor Executor, size_t BatchSize = 64> class actor {
+	static_assert(BatchSize > 0);
+
+public:
+	using message_type = move_only_function<void(State &) &&>;
+
+	static constexpr size_t batch_size = BatchSize;
+	static constexpr size_t default_capacity = 1024;
+
+private:
+	Executor & underlying;
+	State state;
+	_bounded_queue<message_type> mailbox;
+	std::atomic<size_t> pending{0};
+	// activations inside of activate, leaving it is their last access to the actor
+	std::atomic<size_t> active{0};
+
+	void schedule() {
+		underlying.post([this] { activate(); });
+	}
+
+	bool push(message_type & message) {
+		assert(message);
+
+		if (!mailbox.try_push(std::move(message))) {
+			return false;
+		}
+
+		if (pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+			schedule();
+		}
+
+		return true;
+	}
+
+	void activate() {
+		active.fetch_add(1, std::memory_order_relaxed);
+
+		struct leave_t {
+			std::atomic<size_t> & active;
+
+			~leave_t() {
+				active.fetch_sub(1, std::memory_order_release);
+			}
+		} leave{active};
+
+		message_type message;
+
+		for (size_t processed = 1;; ++processed) {
+			// counter was increased after push, so the message is there (possibly still being written)
+			while (!mailbox.try_pop(message)) {
+				std::this_thread::yield();
+			}
+
+			try {
+				std::move(message)(state);
+				message = nullptr;
+			} catch (...) {
+				message = nullptr;
+				if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+					schedule();
+				}
+				throw;
+			}
+
+			if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				return;
+			}
+
+			if (processed == BatchSize) {
+				schedule();
+				return;
+			}
+		}
+	}
+
+public:
+	template <typename... CArgs> explicit actor(Executor & ex, size_t capacity = default_capacity, CArgs &&... args): underlying{ex}, state(std::forward<CArgs>(args)...), mailbox{capacity} { }
+
+	actor(const actor &) = delete;
+	actor & operator=(const actor &) = delete;
+
+	~actor() {
+		while (active.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	// returns false if mailbox is full
+	bool try_send(message_type message) {
+		return push(message);
+	}
+
+	// waits while mailbox is full (don't call it from inside of the actor itself)
+	void send(message_type message) {
+		while (!push(message)) {
+			std::this_thread::yield();
+		}
+	}
+
+	// waits until all sent messages were processed (the executor must be running them, so not from
+	// inside of the actor or with executor polled by the calling thread)
+	void wait_idle() const noexcept {
+		while (pending.load(std::memory_order_acquire) != 0 || active.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	Executor & get_executor() const noexcept {
+		return underlying;
+	}
+};
+
+} // namespace hana23
+
+#endif
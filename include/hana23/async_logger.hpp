@@ -0,0 +1,327 @@
+#ifndef HANA23_ASYNC_LOGGER_HPP
+#define HANA23_ASYNC_LOGGER_HPP
+
+#include "move_only_function.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace hana23 {
+
+// logger which moves formatting and I/O off the logging thread: a log record is a callable capturing
+// the arguments, it's constructed directly in the calling thread's single-producer single-consumer
+// byte ring (behind a header with its consume function, like a vtable) and published with a release
+// store, a background thread invokes it to append formatted text and passes batches to the sink
+
+// records don't use move_only_function's vtables: those operate on its fixed-size storage (inline
+// buffer or heap pointer) and provide move and call separately, a record is a variable-size callable
+// constructed in place in the ring which is never moved, so its header keeps a single function pointer
+// which invokes and destroys it
+
+// callables bigger than a quarter of the ring or over-aligned ones are boxed on heap, a full ring
+// makes the logging thread wait for the background thread (nothing is dropped)
+
+// records of one thread keep their order, records of different threads are only ordered per batch,
+// the sink is only called from the background thread, it must not throw or log through the same
+// logger
+
+class _log_ring {
+	struct alignas(16) header {
+		// nullptr for padding at the end of the ring
+		void (*consume)(void * callable, std::string & out) noexcept;
+		size_t size;
+	};
+
+	template <typename Callable> static void consume_for(void * callable, std::string & out) noexcept {
+		Callable * c = std::launder(static_cast<Callable *>(callable));
+
+		try {
+			std::move(*c)(out);
+		} catch (...) {
+			// nobody to report to, the record is just skipped
+		}
+
+		c->~Callable();
+	}
+
+	std::byte * data;
+	const size_t mask;
+
+	alignas(64) std::atomic<size_t> head{0};
+	// consumer's position, head follows it once the drained text is written
+	size_t drained{0};
+
+	alignas(64) std::atomic<size_t> tail{0};
+	// producer's last seen head, so it doesn't read consumer's cache line on each push
+	size_t cached_head{0};
+
+public:
+	static constexpr size_t alignment = alignof(header);
+
+	template <typename Callable> static constexpr size_t record_size = (sizeof(header) + sizeof(Callable) + alignment - 1) & ~(alignment - 1);
+
+	// capacity must be power of two
+	explicit _log_ring(size_t capacity): data{static_cast<std::byte *>(::operator new(capacity, std::align_val_t{64}))}, mask{capacity - 1} {
+		assert(capacity >= 2 * alignment && (capacity & mask) == 0);
+	}
+
+	_log_ring(const _log_ring &) = delete;
+	_log_ring & operator=(const _log_ring &) = delete;
+
+	~_log_ring() {
+		// owner drains before destroying, so there is usually nothing left
+		std::string ignored;
+		drain(ignored);
+		release();
+		::operator delete(data, std::align_val_t{64});
+	}
+
+	size_t capacity() const noexcept {
+		return mask + 1;
+	}
+
+	// producer only, returns false if there is no space
+	template <typename Callable, typename F> bool try_push(F && f) {
+		static_assert(alignof(Callable) <= alignment);
+		constexpr size_t size = record_size<Callable>;
+
+		size_t position = tail.load(std::memory_order_relaxed);
+		const size_t offset = position & mask;
+		// record is contiguous, rest of the ring is skipped if it doesn't fit there
+		const size_t padding = offset + size > capacity() ? capacity() - offset : 0;
+
+		if (position + padding + size - cached_head > capacity()) {
+			cached_head = head.load(std::memory_order_acquire);
+			if (position + padding + size - cached_head > capacity()) {
+				return false;
+			}
+		}
+
+		if (padding) {
+			new (data + offset) header{nullptr, padding};
+			position += padding;
+		}
+
+		std::byte * record = data + (position & mask);
+		// if this throws nothing is published
+		new (record + sizeof(header)) Callable(std::forward<F>(f));
+		new (record) header{&consume_for<Callable>, size};
+
+		tail.store(position + size, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only, appends published records (each on its own line), returns number of them, their
+	// space is reused after `release`
+	size_t drain(std::string & out) {
+		size_t position = drained;
+		const size_t end = tail.load(std::memory_order_acquire);
+		size_t count = 0;
+
+		while (position != end) {
+			std::byte * record = data + (position & mask);
+			const header * h = std::launder(reinterpret_cast<header *>(record));
+
+			if (h->consume) {
+				h->consume(record + sizeof(header), out);
+				out.push_back('\n');
+				++count;
+			}
+
+			position += h->size;
+		}
+
+		drained = position;
+		return count;
+	}
+
+	void release() noexcept {
+		head.store(drained, std::memory_order_release);
+	}
+
+	size_t published() const noexcept {
+		return tail.load(std::memory_order_acquire);
+	}
+
+	size_t consumed() const noexcept {
+		return head.load(std::memory_order_acquire);
+	}
+};
+
+inline uint64_t _next_async_logger_id() noexcept {
+	static std::atomic<uint64_t> counter{0};
+	return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+class async_logger {
+public:
+	using sink_type = move_only_function<void(std::string_view)>;
+
+	static constexpr size_t default_ring_capacity = 64 * 1024;
+
+private:
+	// ring of the instance this thread logged into last
+	static inline thread_local uint64_t cached_owner = 0;
+	static inline thread_local _log_ring * cached_ring = nullptr;
+
+	const uint64_t id{_next_async_logger_id()};
+	const size_t ring_capacity;
+	const std::chrono::microseconds poll_interval;
+
+	sink_type sink;
+
+	std::mutex mutex{};
+	std::vector<std::pair<std::thread::id, std::unique_ptr<_log_ring>>> rings{};
+
+	std::atomic<bool> stopping{false};
+	std::thread writer;
+
+	static void write_stderr(std::string_view text) noexcept {
+		std::fwrite(text.data(), 1, text.size(), stderr);
+	}
+
+	_log_ring & register_thread() {
+		const std::thread::id self = std::this_thread::get_id();
+		std::lock_guard lock{mutex};
+
+		for (auto & [owner, ring]: rings) {
+			if (owner == self) {
+				return *ring;
+			}
+		}
+
+		rings.emplace_back(self, std::make_unique<_log_ring>(ring_capacity));
+		return *rings.back().second;
+	}
+
+	std::vector<_log_ring *> snapshot() {
+		std::vector<_log_ring *> result;
+		std::lock_guard lock{mutex};
+
+		result.reserve(rings.size());
+		for (auto & entry: rings) {
+			result.push_back(entry.second.get());
+		}
+		return result;
+	}
+
+	size_t drain(std::string & text) {
+		const std::vector<_log_ring *> current = snapshot();
+		size_t count = 0;
+
+		for (_log_ring * ring: current) {
+			count += ring->drain(text);
+		}
+
+		if (!text.empty()) {
+			sink(text);
+			text.clear();
+		}
+
+		// records count as consumed (for `flush`) only when they reached the sink
+		for (_log_ring * ring: current) {
+			ring->release();
+		}
+
+		return count;
+	}
+
+	void write() {
+		// capacity of the batch is kept between rounds
+		std::string text;
+
+		while (!stopping.load(std::memory_order_acquire)) {
+			if (drain(text) == 0) {
+				std::this_thread::sleep_for(poll_interval);
+			}
+		}
+	}
+
+	_log_ring & local() {
+		if (cached_owner != id) {
+			cached_ring = &register_thread();
+			cached_owner = id;
+		}
+		return *cached_ring;
+	}
+
+public:
+	// ring capacity is per logging thread and must be power of two
+	explicit async_logger(sink_type s = write_stderr, size_t capacity = default_ring_capacity, std::chrono::microseconds poll = std::chrono::milliseconds{1}): ring_capacity{capacity}, poll_interval{poll}, sink{std::move(s)}, writer{[this] { write(); }} {
+		assert(sink);
+	}
+
+	async_logger(const async_logger &) = delete;
+	async_logger & operator=(const async_logger &) = delete;
+
+	// everything logged before is written
+	~async_logger() {
+		stopping.store(true, std::memory_order_release);
+		writer.join();
+
+		std::string text;
+		drain(text);
+	}
+
+	// `f` is invoked as rvalue with std::string & on the background thread and appends one record
+	// (without newline), it should capture arguments by value
+	template <typename F> void log(F && f) requires(std::is_invocable_v<std::decay_t<F> &&, std::string &>) {
+		using callable_t = std::decay_t<F>;
+
+		if constexpr (alignof(callable_t) <= _log_ring::alignment) {
+			if (_log_ring::record_size<callable_t> <= ring_capacity / 4) {
+				push<callable_t>(std::forward<F>(f));
+				return;
+			}
+		}
+
+		struct boxed {
+			std::unique_ptr<callable_t> callable;
+
+			void operator()(std::string & out) && {
+				std::move(*callable)(out);
+			}
+		};
+
+		push<boxed>(boxed{std::make_unique<callable_t>(std::forward<F>(f))});
+	}
+
+	// waits until records logged (by any thread) before the call are written
+	void flush() {
+		std::vector<std::pair<_log_ring *, size_t>> targets;
+		for (_log_ring * ring: snapshot()) {
+			targets.emplace_back(ring, ring->published());
+		}
+
+		for (auto [ring, target]: targets) {
+			while (ring->consumed() < target) {
+				std::this_thread::sleep_for(poll_interval);
+			}
+		}
+	}
+
+private:
+	template <typename Callable, typename F> void push(F && f) {
+		_log_ring & ring = local();
+
+		while (!ring.try_push<Callable>(std::forward<F>(f))) {
+			std::this_thread::yield();
+		}
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef HANA23_ATOMIC_FUNCTION_HPP
+#define HANA23_ATOMIC_FUNCTION_HPP
+
+#include "move_only_function.hpp"
+#include "utility/epoch.hpp"
+#include <atomic>
+#include <cassert>
+
+namespace hana23 {
+
+// function which can be replaced while other threads call it: a call announces the epoch, loads the
+// current callable and invokes it (no lock, no reference counting), `store` publishes a new callable
+// and the previous one is reclaimed through epoch-based reclamation once no call can be using it
+
+// the callable is invoked concurrently from all calling threads, so it's stored as const-callable,
+// a call which started before `store` can still finish with the previous callable
+
+template <typename> class atomic_function;
+
+template <typename R, typename... Args> class atomic_function<R(Args...)> {
+public:
+	using function_type = move_only_function<R(Args...) const>;
+
+private:
+	struct node {
+		function_type function;
+	};
+
+	std::atomic<node *> current{nullptr};
+
+	void publish(node * next) {
+		if (node * previous = current.exchange(next, std::memory_order_seq_cst)) {
+			_epoch_domain::domain().retire(previous);
+		}
+	}
+
+public:
+	atomic_function() noexcept = default;
+
+	explicit atomic_function(function_type f): current{f ? new node{std::move(f)} : nullptr} { }
+
+	atomic_function(const atomic_function &) = delete;
+	atomic_function & operator=(const atomic_function &) = delete;
+
+	// no call can be running anymore
+	~atomic_function() {
+		delete current.load(std::memory_order_relaxed);
+	}
+
+	// thread-safe, empty function clears it
+	void store(function_type f) {
+		publish(f ? new node{std::move(f)} : nullptr);
+	}
+
+	explicit operator bool() const noexcept {
+		return current.load(std::memory_order_acquire) != nullptr;
+	}
+
+	// calling empty atomic_function is UB
+	R operator()(Args... args) const {
+		_epoch_domain::guard guard;
+
+		const node * n = current.load(std::memory_order_seq_cst);
+		assert(n != nullptr);
+
+		return n->function(std::forward<Args>(args)...);
+	}
+};
+
+} // namespace hana23
+
+#endif
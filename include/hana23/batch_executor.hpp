@@ -0,0 +1,152 @@
+#ifndef HANA23_BATCH_EXECUTOR_HPP
+#define HANA23_BATCH_EXECUTOR_HPP
+
+#include "utility/task_node.hpp"
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstddef>
+
+namespace hana23 {
+
+// single-threaded executor which groups pending tasks by their type: tasks of one type are stored
+// in their own contiguous bucket and a drain runs each bucket in a tight loop with direct calls,
+// so there is one indirect call per bucket instead of one per task (and the per-task branch is
+// predictable)
+
+// only order of tasks of the same type is kept, buckets run in order of the first post of their type,
+// tasks already erased into move_only_function share one bucket and keep their own indirect call
+
+template <typename T> struct _type_key {
+	static constexpr char value = 0;
+};
+
+class batch_executor {
+	struct bucket_base {
+		virtual ~bucket_base() = default;
+		// runs tasks pending at the start, returns number of invoked tasks
+		virtual size_t run_all() = 0;
+		virtual size_t size() const noexcept = 0;
+	};
+
+	template <typename Callable> struct bucket final: bucket_base {
+		std::vector<Callable> pending{};
+		// batch being run, if a task throws the rest of it runs on the next drain
+		std::vector<Callable> running{};
+		size_t next{0};
+
+		size_t run_all() final {
+			if (running.empty()) {
+				std::swap(pending, running);
+			}
+
+			const size_t first = next;
+
+			while (next != running.size()) {
+				std::invoke(std::move(running[next++]));
+			}
+
+			// capacity of both vectors is kept
+			const size_t invoked = next - first;
+			running.clear();
+			next = 0;
+			return invoked;
+		}
+
+		size_t size() const noexcept final {
+			return pending.size() + (running.size() - next);
+		}
+	};
+
+	std::vector<std::unique_ptr<bucket_base>> buckets{};
+	std::unordered_map<const void *, bucket_base *> index{};
+
+	// most of the time consecutive posts are of the same type
+	const void * last_key{nullptr};
+	bucket_base * last_bucket{nullptr};
+
+	size_t count{0};
+
+	template <typename Callable> bucket<Callable> & bucket_for() {
+		const void * key = &_type_key<Callable>::value;
+
+		if (key != last_key) {
+			auto [it, inserted] = index.try_emplace(key, nullptr);
+
+			if (inserted) {
+				try {
+					buckets.push_back(std::make_unique<bucket<Callable>>());
+				} catch (...) {
+					index.erase(it);
+					throw;
+				}
+				it->second = buckets.back().get();
+			}
+
+			last_key = key;
+			last_bucket = it->second;
+		}
+
+		return *static_cast<bucket<Callable> *>(last_bucket);
+	}
+
+public:
+	batch_executor() = default;
+
+	batch_executor(const batch_executor &) = delete;
+	batch_executor & operator=(const batch_executor &) = delete;
+
+	template <typename F> void post(F && f) requires _is_task_for<F> {
+		bucket_for<std::decay_t<F>>().pending.emplace_back(std::forward<F>(f));
+		++count;
+	}
+
+	size_t size() const noexcept {
+		return count;
+	}
+
+	bool empty() const noexcept {
+		return count == 0;
+	}
+
+	// drains buckets one by one, a bucket's tasks are taken when its turn comes and tasks posted to it
+	// afterwards wait for the next call, returns number of invoked tasks
+	size_t poll() {
+		size_t invoked = 0;
+
+		// recounted even when a task throws
+		struct update_t {
+			batch_executor & ex;
+
+			~update_t() {
+				size_t remaining = 0;
+				for (const auto & b: ex.buckets) {
+					remaining += b->size();
+				}
+				ex.count = remaining;
+			}
+		} update{*this};
+
+		for (size_t i = 0; i != buckets.size(); ++i) {
+			invoked += buckets[i]->run_all();
+		}
+
+		return invoked;
+	}
+
+	// runs until there is nothing to run
+	size_t run() {
+		size_t invoked = 0;
+		while (!empty()) {
+			invoked += poll();
+		}
+		return invoked;
+	}
+};
+
+} // namespace hana23
+
+#endif
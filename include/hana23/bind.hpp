@@ -0,0 +1,80 @@
+#ifndef HANA23_BIND_HPP
+#define HANA23_BIND_HPP
+
+#include "move_only_function.hpp"
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+namespace hana23 {
+
+// bind_front/bind_back constructing the bound state directly inside of move_only_function's storage
+// (it goes to the heap only when it doesn't fit the configured buffer)
+
+// `bind_front<Sig, &C::method>(object_ptr)` takes the callable as template argument, so only the
+// object pointer is stored and the result fits in two words (vtable + default buffer) without allocation,
+// a runtime pointer to member function is two words itself and would never fit
+
+enum class _bind_side { front, back };
+
+// empty stand-in for a callable known at compile time
+template <auto Fn> struct _constant_callable {
+	template <typename... Args> constexpr auto operator()(Args &&... args) const noexcept(std::is_nothrow_invocable_v<decltype(Fn), Args...>) -> std::invoke_result_t<decltype(Fn), Args...> {
+		return std::invoke(Fn, std::forward<Args>(args)...);
+	}
+};
+
+template <_bind_side Side, typename F, typename... Bound> class _bound {
+	[[no_unique_address]] F fn;
+	[[no_unique_address]] std::tuple<Bound...> bound;
+
+	template <typename Self, size_t... Idx, typename... Args> static auto call(Self && self, std::index_sequence<Idx...>, Args &&... args) -> std::invoke_result_t<decltype((std::forward<Self>(self).fn)), decltype(std::get<Idx>(std::forward<Self>(self).bound))..., Args...> requires(Side == _bind_side::front) {
+		// each member is extracted only once, so forwarding self repeatedly is fine
+		return std::invoke(std::forward<Self>(self).fn, std::get<Idx>(std::forward<Self>(self).bound)..., std::forward<Args>(args)...);
+	}
+
+	template <typename Self, size_t... Idx, typename... Args> static auto call(Self && self, std::index_sequence<Idx...>, Args &&... args) -> std::invoke_result_t<decltype((std::forward<Self>(self).fn)), Args..., decltype(std::get<Idx>(std::forward<Self>(self).bound))...> requires(Side == _bind_side::back) {
+		return std::invoke(std::forward<Self>(self).fn, std::forward<Args>(args)..., std::get<Idx>(std::forward<Self>(self).bound)...);
+	}
+
+public:
+	template <typename CF, typename... CArgs> constexpr explicit _bound(CF && f, CArgs &&... args): fn(std::forward<CF>(f)), bound(std::forward<CArgs>(args)...) { }
+
+	template <typename... Args> constexpr auto operator()(Args &&... args) & -> decltype(call(std::declval<_bound &>(), std::index_sequence_for<Bound...>{}, std::declval<Args>()...)) {
+		return call(*this, std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+	}
+
+	template <typename... Args> constexpr auto operator()(Args &&... args) const & -> decltype(call(std::declval<const _bound &>(), std::index_sequence_for<Bound...>{}, std::declval<Args>()...)) {
+		return call(*this, std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+	}
+
+	template <typename... Args> constexpr auto operator()(Args &&... args) && -> decltype(call(std::declval<_bound &&>(), std::index_sequence_for<Bound...>{}, std::declval<Args>()...)) {
+		return call(std::move(*this), std::index_sequence_for<Bound...>{}, std::forward<Args>(args)...);
+	}
+};
+
+template <typename Signature, typename F, typename... Args> move_only_function<Signature> bind_front(F && f, Args &&... args) {
+	using bound_t = _bound<_bind_side::front, std::decay_t<F>, std::decay_t<Args>...>;
+	return move_only_function<Signature>{std::in_place_type<bound_t>, std::forward<F>(f), std::forward<Args>(args)...};
+}
+
+template <typename Signature, auto Fn, typename... Args> move_only_function<Signature> bind_front(Args &&... args) {
+	using bound_t = _bound<_bind_side::front, _constant_callable<Fn>, std::decay_t<Args>...>;
+	return move_only_function<Signature>{std::in_place_type<bound_t>, _constant_callable<Fn>{}, std::forward<Args>(args)...};
+}
+
+template <typename Signature, typename F, typename... Args> move_only_function<Signature> bind_back(F && f, Args &&... args) {
+	using bound_t = _bound<_bind_side::back, std::decay_t<F>, std::decay_t<Args>...>;
+	return move_only_function<Signature>{std::in_place_type<bound_t>, std::forward<F>(f), std::forward<Args>(args)...};
+}
+
+template <typename Signature, auto Fn, typename... Args> move_only_function<Signature> bind_back(Args &&... args) {
+	using bound_t = _bound<_bind_side::back, _constant_callable<Fn>, std::decay_t<Args>...>;
+	return move_only_function<Signature>{std::in_place_type<bound_t>, _constant_callable<Fn>{}, std::forward<Args>(args)...};
+}
+
+} // namespace hana23
+
+#endif
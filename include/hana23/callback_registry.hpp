@@ -0,0 +1,179 @@
+#ifndef HANA23_CALLBACK_REGISTRY_HPP
+#define HANA23_CALLBACK_REGISTRY_HPP
+
+#include "move_only_function.hpp"
+#include "utility/vector_growth.hpp"
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// slot map of callbacks: functions are stored densely (broadcast walks one array), a handle is slot
+// index with generation, so insert, erase and lookup are O(1) without hashing and stale handles are
+// detected
+
+// erase moves the last function into the hole (move_only_function's own move just relocates its
+// storage), so order of broadcast changes after erase, not thread-safe
+
+template <typename Signature> class callback_registry {
+public:
+	using function_type = move_only_function<Signature>;
+
+	struct handle {
+		uint32_t index{invalid};
+		uint32_t generation{0};
+
+		static constexpr uint32_t invalid = static_cast<uint32_t>(-1);
+
+		explicit operator bool() const noexcept {
+			return index != invalid;
+		}
+
+		friend bool operator==(const handle &, const handle &) = default;
+	};
+
+private:
+	static constexpr uint32_t none = static_cast<uint32_t>(-1);
+
+	struct slot_t {
+		// position in dense arrays when occupied, next free slot otherwise
+		uint32_t target;
+		// odd when occupied
+		uint32_t generation;
+	};
+
+	std::vector<function_type> functions{};
+	// slot of each dense element (for fixing the slot of relocated last element)
+	std::vector<uint32_t> owners{};
+	std::vector<slot_t> slots{};
+	uint32_t free_head{none};
+
+	static constexpr bool occupied(uint32_t generation) noexcept {
+		return generation & 1u;
+	}
+
+	const slot_t * slot_of(handle h) const noexcept {
+		if (h.index >= slots.size()) {
+			return nullptr;
+		}
+		const slot_t & s = slots[h.index];
+		return s.generation == h.generation && occupied(s.generation) ? &s : nullptr;
+	}
+
+public:
+	callback_registry() = default;
+
+	size_t size() const noexcept {
+		return functions.size();
+	}
+
+	bool empty() const noexcept {
+		return functions.empty();
+	}
+
+	void reserve(size_t count) {
+		functions.reserve(count);
+		owners.reserve(count);
+		slots.reserve(count);
+	}
+
+	handle insert(function_type f) {
+		assert(f);
+
+		// all allocations first, so a failure doesn't leave anything half inserted
+		_reserve_one_more(functions);
+		_reserve_one_more(owners);
+
+		uint32_t index;
+
+		if (free_head != none) {
+			index = free_head;
+			free_head = slots[index].target;
+		} else {
+			assert(slots.size() < none);
+			index = static_cast<uint32_t>(slots.size());
+			slots.push_back({none, 0});
+		}
+
+		slot_t & s = slots[index];
+		s.target = static_cast<uint32_t>(functions.size());
+		++s.generation;
+
+		functions.push_back(std::move(f));
+		owners.push_back(index);
+
+		return {index, s.generation};
+	}
+
+	bool contains(handle h) const noexcept {
+		return slot_of(h) != nullptr;
+	}
+
+	// nullptr for stale handle
+	function_type * find(handle h) noexcept {
+		const slot_t * s = slot_of(h);
+		return s ? &functions[s->target] : nullptr;
+	}
+
+	const function_type * find(handle h) const noexcept {
+		const slot_t * s = slot_of(h);
+		return s ? &functions[s->target] : nullptr;
+	}
+
+	// returns false for stale handle
+	bool erase(handle h) noexcept {
+		if (!slot_of(h)) {
+			return false;
+		}
+
+		slot_t & s = slots[h.index];
+		const uint32_t position = s.target;
+		const uint32_t last = static_cast<uint32_t>(functions.size() - 1);
+
+		if (position != last) {
+			functions[position] = std::move(functions[last]);
+			owners[position] = owners[last];
+			slots[owners[position]].target = position;
+		}
+
+		functions.pop_back();
+		owners.pop_back();
+
+		++s.generation;
+		s.target = free_head;
+		free_head = h.index;
+		return true;
+	}
+
+	void clear() noexcept {
+		while (!owners.empty()) {
+			const uint32_t index = owners.back();
+			erase({index, slots[index].generation});
+		}
+	}
+
+	// invokes all callbacks, arguments are passed to each of them as lvalues
+	template <typename... Args> void broadcast(Args &&... args) requires(std::is_invocable_v<function_type &, Args &...>) {
+		for (function_type & f: functions) {
+			f(args...);
+		}
+	}
+
+	// dense storage, order is unspecified
+	std::span<function_type> callbacks() noexcept {
+		return functions;
+	}
+
+	std::span<const function_type> callbacks() const noexcept {
+		return functions;
+	}
+};
+
+} // namespace hana23
+
+#endif
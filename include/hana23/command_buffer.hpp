@@ -0,0 +1,303 @@
+#ifndef HANA23_COMMAND_BUFFER_HPP
+#define HANA23_COMMAND_BUFFER_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// deferred one-shot commands recorded into a monotonic arena of reusable blocks, recording is just
+// bump allocation and `replay` invokes (and destroys) them in recorded order, then the arena is
+// rewound, blocks stay allocated for the next round
+
+// trivially destructible commands have no destroy step at all, `reset` only walks the recorded
+// commands when some of them aren't trivially destructible (otherwise it's O(1)), commands recorded
+// while replaying are part of the same replay
+
+template <typename> class command_buffer;
+
+template <typename... Args> class command_buffer<void(Args...)> {
+	struct header {
+		void (*invoke)(header * self, Args... args);
+		// nullptr for trivially destructible callables
+		void (*destroy)(header * self) noexcept;
+		header * next;
+	};
+
+	struct block {
+		std::unique_ptr<std::byte[]> memory;
+		size_t size;
+	};
+
+	template <typename Callable> static constexpr size_t callable_offset = (sizeof(header) + alignof(Callable) - 1) & ~(alignof(Callable) - 1);
+
+	template <typename Callable> static Callable * callable_of(header * self) noexcept {
+		return std::launder(reinterpret_cast<Callable *>(reinterpret_cast<std::byte *>(self) + callable_offset<Callable>));
+	}
+
+	template <typename Callable> static void invoke_for(header * self, Args... args) {
+		Callable * callable = callable_of<Callable>(self);
+
+		if constexpr (std::is_trivially_destructible_v<Callable>) {
+			std::invoke(std::move(*callable), static_cast<Args &&>(args)...);
+		} else {
+			struct destroy_t {
+				Callable * callable;
+				~destroy_t() {
+					callable->~Callable();
+				}
+			} destroy{callable};
+
+			std::invoke(std::move(*callable), static_cast<Args &&>(args)...);
+		}
+	}
+
+	template <typename Callable> static void destroy_for(header * self) noexcept {
+		callable_of<Callable>(self)->~Callable();
+	}
+
+	const size_t block_size;
+	std::vector<block> blocks{};
+	size_t next_block{0};
+	std::byte * cursor{nullptr};
+	std::byte * limit{nullptr};
+
+	header * head{nullptr};
+	header * tail{nullptr};
+	size_t pending{0};
+	// pending commands which aren't trivially destructible
+	size_t destructible{0};
+
+	void * allocate(size_t size, size_t alignment) {
+		for (;;) {
+			if (cursor) {
+				const auto address = reinterpret_cast<uintptr_t>(cursor);
+				std::byte * result = cursor + (((address + alignment - 1) & ~(alignment - 1)) - address);
+
+				if (result + size <= limit) {
+					cursor = result + size;
+					return result;
+				}
+			}
+
+			use_next_block(size + alignment);
+		}
+	}
+
+	void use_next_block(size_t minimal) {
+		// too small blocks are skipped this round (oversized commands get their own block)
+		while (next_block != blocks.size() && blocks[next_block].size < minimal) {
+			++next_block;
+		}
+
+		if (next_block == blocks.size()) {
+			const size_t size = minimal > block_size ? minimal : block_size;
+			blocks.push_back({std::make_unique_for_overwrite<std::byte[]>(size), size});
+		}
+
+		cursor = blocks[next_block].memory.get();
+		limit = cursor + blocks[next_block].size;
+		++next_block;
+	}
+
+public:
+	static constexpr size_t default_block_size = 64 * 1024;
+
+	explicit command_buffer(size_t block = default_block_size) noexcept: block_size{block} { }
+
+	command_buffer(const command_buffer &) = delete;
+	command_buffer & operator=(const command_buffer &) = delete;
+
+	~command_buffer() {
+		reset();
+	}
+
+	size_t size() const noexcept {
+		return pending;
+	}
+
+	bool empty() const noexcept {
+		return pending == 0;
+	}
+
+	template <typename F> void record(F && f) requires(std::is_invocable_v<std::decay_t<F> &&, Args...>) {
+		using callable_t = std::decay_t<F>;
+
+		constexpr size_t alignment = alignof(callable_t) > alignof(header) ? alignof(callable_t) : alignof(header);
+		void * memory = allocate(callable_offset<callable_t> + sizeof(callable_t), alignment);
+
+		// on exception the memory is just left unused until reset
+		new (static_cast<std::byte *>(memory) + callable_offset<callable_t>) callable_t(std::forward<F>(f));
+
+		header * h = new (memory) header{&invoke_for<callable_t>, nullptr, nullptr};
+		if constexpr (!std::is_trivially_destructible_v<callable_t>) {
+			h->destroy = &destroy_for<callable_t>;
+			++destructible;
+		}
+
+		if (tail) {
+			tail->next = h;
+		} else {
+			head = h;
+		}
+
+		tail = h;
+		++pending;
+	}
+
+	// invokes commands in recorded order and resets the buffer, if a command throws the rest stays
+	// recorded for the next replay
+	void replay(Args... args) {
+		while (head) {
+			header * h = head;
+
+			// next is read after the invocation, as the command could have recorded another one
+			struct advance_t {
+				command_buffer & buffer;
+				header * h;
+
+				~advance_t() {
+					buffer.head = h->next;
+					if (!buffer.head) {
+						buffer.tail = nullptr;
+					}
+					--buffer.pending;
+					// invocation destroyed the command
+					if (h->destroy) {
+						--buffer.destructible;
+					}
+				}
+			} advance{*this, h};
+
+			h->invoke(h, args...);
+		}
+
+		reset();
+	}
+
+	// drops recorded commands without invoking them, O(1) when there is nothing to destroy
+	void reset() noexcept {
+		if (destructible != 0) {
+			for (header * h = head; h; h = h->next) {
+				if (h->destroy) {
+					h->destroy(h);
+				}
+			}
+		}
+
+		head = nullptr;
+		tail = nullptr;
+		pending = 0;
+		destructible = 0;
+		next_block = 0;
+		cursor = nullptr;
+		limit = nullptr;
+	}
+};
+
+inline uint64_t _next_command_buffers_id() noexcept {
+	static std::atomic<uint64_t> counter{0};
+	return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// one command_buffer per recording thread, recording doesn't synchronize except for the first
+// command from a thread (its buffer is registered under a lock)
+
+// `replay` must not run concurrently with recording (e.g. it's called between frames), buffers are
+// replayed in order of their registration, so commands of one thread keep their order
+
+// each thread caches the buffer of the last used command_buffers, alternating between several
+// instances from one thread takes the lock on each switch
+
+template <typename> class command_buffers;
+
+template <typename... Args> class command_buffers<void(Args...)> {
+public:
+	using buffer_type = command_buffer<void(Args...)>;
+
+private:
+	// buffer of the instance this thread recorded into last
+	static inline thread_local uint64_t cached_owner = 0;
+	static inline thread_local buffer_type * cached_buffer = nullptr;
+
+	const uint64_t id{_next_command_buffers_id()};
+	const size_t block_size;
+
+	std::mutex mutex{};
+	std::vector<std::pair<std::thread::id, std::unique_ptr<buffer_type>>> buffers{};
+
+	buffer_type & register_thread() {
+		const std::thread::id self = std::this_thread::get_id();
+		std::lock_guard lock{mutex};
+
+		for (auto & [owner, buffer]: buffers) {
+			if (owner == self) {
+				return *buffer;
+			}
+		}
+
+		buffers.emplace_back(self, std::make_unique<buffer_type>(block_size));
+		return *buffers.back().second;
+	}
+
+public:
+	explicit command_buffers(size_t block = buffer_type::default_block_size) noexcept: block_size{block} { }
+
+	command_buffers(const command_buffers &) = delete;
+	command_buffers & operator=(const command_buffers &) = delete;
+
+	// buffer of calling thread
+	buffer_type & local() {
+		if (cached_owner != id) {
+			cached_buffer = &register_thread();
+			cached_owner = id;
+		}
+		return *cached_buffer;
+	}
+
+	template <typename F> void record(F && f) requires(std::is_invocable_v<std::decay_t<F> &&, Args...>) {
+		local().record(std::forward<F>(f));
+	}
+
+	// replays all buffers one after another
+	void replay(Args... args) {
+		// commands can record (and register a new buffer) while being replayed, so no lock is held
+		std::vector<buffer_type *> snapshot;
+		{
+			std::lock_guard lock{mutex};
+			snapshot.reserve(buffers.size());
+			for (auto & entry: buffers) {
+				snapshot.push_back(entry.second.get());
+			}
+		}
+
+		for (buffer_type * buffer: snapshot) {
+			buffer->replay(args...);
+		}
+	}
+
+	// number of recorded commands (only when nobody records)
+	size_t size() {
+		std::lock_guard lock{mutex};
+
+		size_t result = 0;
+		for (auto & entry: buffers) {
+			result += entry.second->size();
+		}
+		return result;
+	}
+};
+
+} // namespace hana23
+
+#endif
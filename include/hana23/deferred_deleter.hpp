@@ -0,0 +1,90 @@
+#ifndef HANA23_DEFERRED_DELETER_HPP
+#define HANA23_DEFERRED_DELETER_HPP
+
+#include "move_only_function.hpp"
+#include "utility/bounded_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <cstddef>
+
+namespace hana23 {
+
+// background thread destroying heap allocated callables of move_only_functions, so latency-critical
+// threads don't run arbitrarily expensive destructors (and frees) inline
+
+// it's opt-in per thread: while a `scope` is alive on a thread, heap callables destroyed there are
+// pushed into a lock-free bounded queue (no allocation, no syscall), when the queue is full the
+// callable is destroyed inline, callables stored in the inline buffer are always destroyed inline
+
+// the reclaiming thread polls the queue, so a deferred callable can live up to `poll_interval`
+// longer, the deleter must outlive all of its scopes
+
+class deferred_deleter final: _deferred_destruction {
+	struct entry {
+		void * object{nullptr};
+		void (*destroy)(void *) noexcept {nullptr};
+	};
+
+	_bounded_queue<entry> queue;
+	const std::chrono::microseconds poll_interval;
+	std::atomic<bool> stopping{false};
+	std::thread reclaimer;
+
+	bool defer(void * object, void (*destroy)(void *) noexcept) noexcept final {
+		return queue.try_push(entry{object, destroy});
+	}
+
+	size_t drain() noexcept {
+		size_t count = 0;
+		entry e;
+
+		while (queue.try_pop(e)) {
+			e.destroy(e.object);
+			++count;
+		}
+
+		return count;
+	}
+
+	void reclaim() noexcept {
+		while (!stopping.load(std::memory_order_acquire)) {
+			if (drain() == 0) {
+				std::this_thread::sleep_for(poll_interval);
+			}
+		}
+	}
+
+public:
+	explicit deferred_deleter(size_t capacity = 4096, std::chrono::microseconds poll = std::chrono::milliseconds{1}): queue{capacity}, poll_interval{poll}, reclaimer{[this] { reclaim(); }} { }
+
+	deferred_deleter(const deferred_deleter &) = delete;
+	deferred_deleter & operator=(const deferred_deleter &) = delete;
+
+	// what's still queued is destroyed on the calling thread
+	~deferred_deleter() {
+		stopping.store(true, std::memory_order_release);
+		reclaimer.join();
+		drain();
+	}
+
+	// hands destruction of heap callables over to the deleter while alive, scopes can nest
+	class scope {
+		_deferred_destruction * previous;
+
+	public:
+		explicit scope(deferred_deleter & deleter) noexcept: previous{std::exchange(_deferred_destruction_target, static_cast<_deferred_destruction *>(&deleter))} { }
+
+		scope(const scope &) = delete;
+		scope & operator=(const scope &) = delete;
+
+		~scope() {
+			_deferred_destruction_target = previous;
+		}
+	};
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,348 @@
+#ifndef HANA23_EVENT_LOOP_HPP
+#define HANA23_EVENT_LOOP_HPP
+
+// linux only (epoll + eventfd)
+
+#include "move_only_function.hpp"
+#include "timer_wheel.hpp"
+#include "utility/event_handler.hpp"
+#include "utility/mpsc_queue.hpp"
+#include "utility/task_node.hpp"
+#include <atomic>
+#include <chrono>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace hana23 {
+
+// single-threaded reactor: persistent per-fd read/write handlers live in a dense fd-indexed array,
+// one-shot work (posted tasks and timers) uses `void() &&` callables
+
+// `post` and `stop` are the only thread-safe functions, posted tasks are linked through lock-free
+// MPSC queue and the loop is woken up through eventfd only when it's not already about to be woken
+
+// timers have millisecond resolution and are driven by timer_wheel (not timerfd, so scheduling and
+// cancelling a timer is no syscall), epoll_wait's timeout is set to the wheel's next event
+
+// fd handlers have inline storage of four pointers, so typical handlers (capturing few pointers or
+// integers) don't allocate regardless of move_only_function's buffer size
+
+class event_loop {
+public:
+	using handler_type = _event_handler;
+	using clock = std::chrono::steady_clock;
+	using timer_handle = timer_wheel::handle;
+
+	static constexpr int read_events = EPOLLIN | EPOLLPRI | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+	static constexpr int write_events = EPOLLOUT | EPOLLHUP | EPOLLERR;
+
+private:
+	struct node: _task_node<>, _mpsc_hook {
+		using task_base = _task_node<>;
+		using task_base::task_base;
+	};
+
+	struct fd_state {
+		handler_type read{};
+		handler_type write{};
+		uint32_t registered{0};
+	};
+
+	enum class direction { read, write };
+
+	// handler being invoked, so (un)registering it from inside of itself is safe
+	struct dispatching_t {
+		int fd{-1};
+		direction dir{direction::read};
+		bool replaced{false};
+	};
+
+	int epoll_fd{-1};
+	int wake_fd{-1};
+
+	std::vector<fd_state> fds{};
+	std::vector<epoll_event> events;
+	dispatching_t dispatching{};
+
+	timer_wheel timers{};
+	const clock::time_point origin{clock::now()};
+
+	_mpsc_queue<node> posted{};
+	std::atomic<bool> wake_pending{false};
+	std::atomic<bool> stopping{false};
+
+	[[noreturn]] static void throw_errno(const char * what) {
+		throw std::system_error(errno, std::system_category(), what);
+	}
+
+	timer_wheel::tick_t now_tick() const noexcept {
+		return static_cast<timer_wheel::tick_t>(std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - origin).count());
+	}
+
+	void wake() noexcept {
+		if (!wake_pending.exchange(true, std::memory_order_acq_rel)) {
+			const uint64_t one = 1;
+			[[maybe_unused]] const auto r = ::write(wake_fd, &one, sizeof(one));
+		}
+	}
+
+	// handler moved out for invocation is still registered unless it was replaced meanwhile
+	bool is_dispatching(int fd, direction dir) const noexcept {
+		return dispatching.fd == fd && dispatching.dir == dir && !dispatching.replaced;
+	}
+
+	void update(int fd) {
+		fd_state & state = fds[static_cast<size_t>(fd)];
+		const bool has_read = state.read || is_dispatching(fd, direction::read);
+		const bool has_write = state.write || is_dispatching(fd, direction::write);
+		const uint32_t wanted = (has_read ? uint32_t{EPOLLIN | EPOLLRDHUP} : 0u) | (has_write ? uint32_t{EPOLLOUT} : 0u);
+
+		if (wanted == state.registered) {
+			return;
+		}
+
+		epoll_event ev{};
+		ev.events = wanted;
+		ev.data.fd = fd;
+
+		const int op = wanted == 0 ? EPOLL_CTL_DEL : (state.registered == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD);
+
+		if (::epoll_ctl(epoll_fd, op, fd, &ev) != 0) {
+			throw_errno("epoll_ctl");
+		}
+
+		state.registered = wanted;
+	}
+
+	void set_handler(int fd, direction dir, handler_type handler) {
+		assert(fd >= 0);
+
+		if (static_cast<size_t>(fd) >= fds.size()) {
+			if (!handler) {
+				return;
+			}
+			fds.resize(static_cast<size_t>(fd) + 1);
+		}
+
+		fd_state & state = fds[static_cast<size_t>(fd)];
+		handler_type & slot = dir == direction::read ? state.read : state.write;
+		handler_type previous = std::exchange(slot, std::move(handler));
+
+		if (dispatching.fd == fd && dispatching.dir == dir) {
+			dispatching.replaced = true;
+		}
+
+		try {
+			update(fd);
+		} catch (...) {
+			slot = std::move(previous);
+			throw;
+		}
+	}
+
+	void dispatch(int fd, direction dir, int ev) {
+		handler_type & slot = dir == direction::read ? fds[static_cast<size_t>(fd)].read : fds[static_cast<size_t>(fd)].write;
+
+		if (!slot) {
+			return;
+		}
+
+		// the handler is moved out as it can replace itself or make the array grow
+		handler_type handler = std::move(slot);
+		dispatching = {fd, dir, false};
+
+		struct restore_t {
+			event_loop & loop;
+			handler_type & handler;
+			int fd;
+			direction dir;
+
+			~restore_t() {
+				if (!loop.dispatching.replaced) {
+					fd_state & state = loop.fds[static_cast<size_t>(fd)];
+					(dir == direction::read ? state.read : state.write) = std::move(handler);
+				}
+				loop.dispatching = {};
+			}
+		} restore{*this, handler, fd, dir};
+
+		handler(ev);
+	}
+
+	size_t run_posted() {
+		// read-modify-write, so it either reads the flag set by a producer (and sees its push) or the
+		// producer's exchange comes later and reads false (and writes to eventfd), a plain store
+		// isn't ordered before the loads of the queue
+		wake_pending.exchange(false, std::memory_order_acq_rel);
+
+		size_t count = 0;
+		while (node * n = posted.try_pop()) {
+			std::move(*n)();
+			++count;
+		}
+
+		return count;
+	}
+
+	size_t process(int timeout_ms) {
+		const int ready = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+
+		if (ready < 0) {
+			if (errno == EINTR) {
+				return 0;
+			}
+			throw_errno("epoll_wait");
+		}
+
+		size_t count = 0;
+
+		for (int i = 0; i != ready; ++i) {
+			const int fd = events[static_cast<size_t>(i)].data.fd;
+			const int ev = static_cast<int>(events[static_cast<size_t>(i)].events);
+
+			if (fd == wake_fd) {
+				uint64_t value;
+				[[maybe_unused]] const auto r = ::read(wake_fd, &value, sizeof(value));
+				count += run_posted();
+				continue;
+			}
+
+			// handler of previous event could have removed this fd
+			if (static_cast<size_t>(fd) >= fds.size()) {
+				continue;
+			}
+
+			if (ev & read_events) {
+				dispatch(fd, direction::read, ev);
+				++count;
+			}
+
+			if (ev & write_events) {
+				dispatch(fd, direction::write, ev);
+				++count;
+			}
+		}
+
+		return count + timers.advance_to(now_tick());
+	}
+
+	int timeout_for(timer_wheel::tick_t next) const noexcept {
+		if (timers.empty()) {
+			return -1;
+		}
+
+		const timer_wheel::tick_t now = now_tick();
+
+		if (next <= now) {
+			return 0;
+		}
+
+		const timer_wheel::tick_t difference = next - now;
+		return difference > 60'000 ? 60'000 : static_cast<int>(difference);
+	}
+
+public:
+	explicit event_loop(size_t max_events = 256): events(max_events) {
+		epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_fd < 0) {
+			throw_errno("epoll_create1");
+		}
+
+		wake_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (wake_fd < 0) {
+			::close(epoll_fd);
+			throw_errno("eventfd");
+		}
+
+		epoll_event ev{};
+		ev.events = EPOLLIN;
+		ev.data.fd = wake_fd;
+
+		if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) != 0) {
+			::close(wake_fd);
+			::close(epoll_fd);
+			throw_errno("epoll_ctl");
+		}
+	}
+
+	event_loop(const event_loop &) = delete;
+	event_loop & operator=(const event_loop &) = delete;
+
+	// pending tasks and timers are destroyed without being invoked, fds are not closed
+	~event_loop() {
+		while (node * n = posted.try_pop()) {
+			n->destroy();
+		}
+
+		::close(wake_fd);
+		::close(epoll_fd);
+	}
+
+	// handler is invoked with epoll's events while fd is readable (empty handler unregisters)
+	void on_readable(int fd, handler_type handler) {
+		set_handler(fd, direction::read, std::move(handler));
+	}
+
+	// handler is invoked with epoll's events while fd is writable (empty handler unregisters)
+	void on_writable(int fd, handler_type handler) {
+		set_handler(fd, direction::write, std::move(handler));
+	}
+
+	// needs to be called before closing fd which has handlers
+	void remove(int fd) {
+		set_handler(fd, direction::read, nullptr);
+		set_handler(fd, direction::write, nullptr);
+	}
+
+	// thread-safe
+	template <typename F> void post(F && f) requires _is_task_for<F> {
+		posted.push(_make_task_node<node>(std::forward<F>(f)));
+		wake();
+	}
+
+	timer_handle schedule_after(std::chrono::milliseconds delay, move_only_function<void() &&> callback) {
+		// wheel can be behind, as it's only advanced when the loop runs
+		const timer_wheel::tick_t at = now_tick() + static_cast<timer_wheel::tick_t>(delay.count() < 0 ? 0 : delay.count());
+		return timers.schedule_at(at, std::move(callback));
+	}
+
+	bool cancel(timer_handle handle) noexcept {
+		return timers.cancel(handle);
+	}
+
+	// waits for and processes one batch of events, returns number of invoked handlers, tasks and timers
+	size_t run_once() {
+		return process(timeout_for(timers.next_event()));
+	}
+
+	// processes what is ready without waiting
+	size_t poll() {
+		return process(0);
+	}
+
+	// runs until `stop` is called
+	void run() {
+		while (!stopping.load(std::memory_order_acquire)) {
+			run_once();
+		}
+		stopping.store(false, std::memory_order_relaxed);
+	}
+
+	// thread-safe
+	void stop() noexcept {
+		stopping.store(true, std::memory_order_release);
+		wake();
+	}
+};
+
+} // namespace hana23
+
+#endif
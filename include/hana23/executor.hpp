@@ -0,0 +1,18 @@
+#ifndef HANA23_EXECUTOR_HPP
+#define HANA23_EXECUTOR_HPP
+
+#include "move_only_function.hpp"
+#include <concepts>
+#include <utility>
+
+namespace hana23 {
+
+// anything accepting one-shot tasks for later execution
+
+template <typename E> concept executor = requires(E & ex, move_only_function<void() &&> task) {
+	ex.post(std::move(task));
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,286 @@
+#ifndef HANA23_FIBER_SCHEDULER_HPP
+#define HANA23_FIBER_SCHEDULER_HPP
+
+// linux x86-64 only
+
+#include "utility/fiber_context.hpp"
+#include "utility/task_node.hpp"
+#include "utility/vector_growth.hpp"
+#include <exception>
+#include <functional>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace hana23 {
+
+// cooperative user-space threads running on the thread which calls `run`
+
+// stacks are mmap-ed with a guard page below them and recycled through a pool, fiber's control
+// block and its body are constructed at the top of its own stack, so spawning a fiber with a
+// recycled stack doesn't allocate at all
+
+// a body which throws terminates the program (same as with std::thread)
+
+class fiber_scheduler {
+public:
+	class fiber;
+
+private:
+	struct stack_t {
+		void * memory{nullptr};
+		size_t size{0};
+
+		char * bottom() const noexcept {
+			return static_cast<char *>(memory) + page_size();
+		}
+
+		char * top() const noexcept {
+			return static_cast<char *>(memory) + size;
+		}
+	};
+
+	static size_t page_size() noexcept {
+		static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+		return size;
+	}
+
+public:
+	class fiber {
+		friend fiber_scheduler;
+
+		fiber_scheduler * scheduler;
+		stack_t stack;
+		void * sp{nullptr};
+		fiber * next{nullptr};
+		void (*invoke_and_destroy)(void * callable){nullptr};
+		void * callable{nullptr};
+		bool finished{false};
+
+		fiber(fiber_scheduler * s, stack_t st) noexcept: scheduler{s}, stack{st} { }
+	};
+
+private:
+	const size_t stack_size;
+	std::vector<stack_t> stacks{};
+	std::vector<stack_t> free_stacks{};
+
+	fiber * ready_head{nullptr};
+	fiber * ready_tail{nullptr};
+	fiber * running{nullptr};
+	size_t alive{0};
+
+	// context of `run`
+	void * scheduler_sp{nullptr};
+	const void * scheduler_stack_bottom{nullptr};
+	size_t scheduler_stack_size{0};
+
+	stack_t acquire_stack() {
+		if (!free_stacks.empty()) {
+			stack_t result = free_stacks.back();
+			free_stacks.pop_back();
+			return result;
+		}
+
+		// bookkeeping is allocated first, so a failure can't leak the mapping, released stacks are
+		// pushed into free_stacks without allocating
+		_reserve_one_more(stacks);
+		if (free_stacks.capacity() < stacks.capacity()) {
+			free_stacks.reserve(stacks.capacity());
+		}
+
+		const size_t total = stack_size + page_size();
+		void * memory = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+
+		if (memory == MAP_FAILED) {
+			throw std::system_error(errno, std::system_category(), "mmap");
+		}
+
+		// guard page, overflow crashes instead of overwriting other memory
+		if (::mprotect(memory, page_size(), PROT_NONE) != 0) {
+			const int error = errno;
+			::munmap(memory, total);
+			throw std::system_error(error, std::system_category(), "mprotect");
+		}
+
+		stacks.push_back({memory, total});
+		return stacks.back();
+	}
+
+	void push_ready(fiber * f) noexcept {
+		f->next = nullptr;
+		if (ready_tail) {
+			ready_tail->next = f;
+		} else {
+			ready_head = f;
+		}
+		ready_tail = f;
+	}
+
+	fiber * pop_ready() noexcept {
+		fiber * f = ready_head;
+		if (f) {
+			ready_head = f->next;
+			if (!ready_head) {
+				ready_tail = nullptr;
+			}
+			f->next = nullptr;
+		}
+		return f;
+	}
+
+	[[noreturn]] static void entry(void * argument) noexcept {
+		fiber * self = static_cast<fiber *>(argument);
+		fiber_scheduler & scheduler = *self->scheduler;
+
+		_fiber_sanitizer::finish_switch(nullptr, &scheduler.scheduler_stack_bottom, &scheduler.scheduler_stack_size);
+
+		// there is no frame to unwind into, so exceptions are fatal
+		self->invoke_and_destroy(self->callable);
+		self->finished = true;
+
+		_fiber_sanitizer::start_switch(nullptr, scheduler.scheduler_stack_bottom, scheduler.scheduler_stack_size);
+		_hana23_fiber_switch(&self->sp, scheduler.scheduler_sp);
+
+		// finished fiber is never resumed
+		std::terminate();
+	}
+
+	template <typename Callable> static void invoke_and_destroy_for(void * ptr) noexcept {
+		Callable * callable = static_cast<Callable *>(ptr);
+		std::invoke(std::move(*callable));
+		callable->~Callable();
+	}
+
+	// switch from running fiber back to `run`
+	void switch_to_scheduler(fiber * self) noexcept {
+		void * fake_stack = nullptr;
+		_fiber_sanitizer::start_switch(&fake_stack, scheduler_stack_bottom, scheduler_stack_size);
+		_hana23_fiber_switch(&self->sp, scheduler_sp);
+		_fiber_sanitizer::finish_switch(fake_stack, &scheduler_stack_bottom, &scheduler_stack_size);
+	}
+
+	void switch_to(fiber * f) noexcept {
+		running = f;
+
+		void * fake_stack = nullptr;
+		_fiber_sanitizer::start_switch(&fake_stack, f->stack.bottom(), static_cast<size_t>(f->stack.top() - f->stack.bottom()));
+		_hana23_fiber_switch(&scheduler_sp, f->sp);
+		_fiber_sanitizer::finish_switch(fake_stack, nullptr, nullptr);
+
+		running = nullptr;
+
+		if (f->finished) {
+			const stack_t stack = f->stack;
+			f->~fiber();
+			free_stacks.push_back(stack);
+			--alive;
+		}
+	}
+
+public:
+	static constexpr size_t default_stack_size = 64 * 1024;
+
+	// stack size is rounded up to whole pages
+	explicit fiber_scheduler(size_t stack = default_stack_size): stack_size{(stack + page_size() - 1) / page_size() * page_size()} { }
+
+	fiber_scheduler(const fiber_scheduler &) = delete;
+	fiber_scheduler & operator=(const fiber_scheduler &) = delete;
+
+	// fibers which never finished are dropped without running their destructors
+	~fiber_scheduler() {
+		assert(running == nullptr);
+
+		for (const stack_t & stack: stacks) {
+			::munmap(stack.memory, stack.size);
+		}
+	}
+
+	template <typename F> fiber * spawn(F && f) requires _is_task_for<F> {
+		using callable_t = std::decay_t<F>;
+
+		const stack_t stack = acquire_stack();
+
+		// [callable][fiber] at the top of the stack, the stack itself continues below them
+		auto top = reinterpret_cast<uintptr_t>(stack.top());
+		top = (top - sizeof(fiber)) & ~uintptr_t{alignof(std::max_align_t) - 1};
+		const uintptr_t control = top;
+		top = (top - sizeof(callable_t)) & ~uintptr_t{(alignof(callable_t) > 16 ? alignof(callable_t) : 16) - 1};
+		const uintptr_t body = top;
+
+		assert(reinterpret_cast<uintptr_t>(stack.top()) - top < stack_size / 2);
+
+		callable_t * callable;
+
+		try {
+			callable = new (reinterpret_cast<void *>(body)) callable_t(std::forward<F>(f));
+		} catch (...) {
+			free_stacks.push_back(stack);
+			throw;
+		}
+
+		fiber * result = new (reinterpret_cast<void *>(control)) fiber(this, stack);
+		result->callable = callable;
+		result->invoke_and_destroy = &invoke_and_destroy_for<callable_t>;
+		result->sp = _make_fiber_context(reinterpret_cast<void *>(body), &entry, result);
+
+		++alive;
+		push_ready(result);
+		return result;
+	}
+
+	// runs on current thread until all fibers finish or there is no ready fiber (all suspended)
+	void run() {
+		assert(running == nullptr);
+
+		while (fiber * f = pop_ready()) {
+			switch_to(f);
+		}
+	}
+
+	// fiber currently running, nullptr outside of fibers
+	fiber * current() const noexcept {
+		return running;
+	}
+
+	// lets other ready fibers run (only from inside of a fiber)
+	void yield() noexcept {
+		fiber * self = running;
+		assert(self != nullptr);
+
+		push_ready(self);
+		switch_to_scheduler(self);
+	}
+
+	// stops running current fiber until someone calls `resume` with it (only from inside of a fiber)
+	void suspend() noexcept {
+		fiber * self = running;
+		assert(self != nullptr);
+
+		switch_to_scheduler(self);
+	}
+
+	// makes suspended fiber ready again
+	void resume(fiber * f) noexcept {
+		assert(f != nullptr && f != running && !f->finished);
+		push_ready(f);
+	}
+
+	// number of fibers which haven't finished yet
+	size_t size() const noexcept {
+		return alive;
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,363 @@
+#ifndef HANA23_FUNCTION_MAP_HPP
+#define HANA23_FUNCTION_MAP_HPP
+
+#include "move_only_function.hpp"
+#include <bit>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HANA23_SWISS_SSE2 1
+#endif
+
+namespace hana23 {
+
+// open-addressing hash map from keys to move_only_functions (swiss table layout): one control byte
+// per slot holds 7 bits of the hash, a probe compares whole group of 16 control bytes at once, and
+// each slot keeps the key and the function (with its inline buffer) next to each other, so lookup
+// with dispatch usually touches one cache line of control bytes and one of slots
+
+// probing goes over aligned groups in triangular sequence, maximal load is 7/8, not thread-safe
+
+struct _swiss_group {
+	static constexpr size_t width = 16;
+
+	static constexpr int8_t empty = -128;
+	static constexpr int8_t deleted = -2;
+
+#ifdef HANA23_SWISS_SSE2
+	__m128i ctrl;
+
+	explicit _swiss_group(const int8_t * position) noexcept: ctrl{_mm_load_si128(reinterpret_cast<const __m128i *>(position))} { }
+
+	uint32_t match(int8_t h2) const noexcept {
+		return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2))));
+	}
+
+	// full slots have the highest bit clear
+	uint32_t match_free() const noexcept {
+		return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+	}
+#else
+	int8_t ctrl[width];
+
+	explicit _swiss_group(const int8_t * position) noexcept {
+		std::memcpy(ctrl, position, width);
+	}
+
+	uint32_t match(int8_t h2) const noexcept {
+		uint32_t result = 0;
+		for (size_t i = 0; i != width; ++i) {
+			result |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+		}
+		return result;
+	}
+
+	uint32_t match_free() const noexcept {
+		uint32_t result = 0;
+		for (size_t i = 0; i != width; ++i) {
+			result |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+		}
+		return result;
+	}
+#endif
+
+	uint32_t match_empty() const noexcept {
+		return match(empty);
+	}
+};
+
+template <typename Key, typename Signature, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>> class function_map {
+	static_assert(std::is_nothrow_move_constructible_v<Key>, "keys are relocated during rehash");
+
+public:
+	using key_type = Key;
+	using function_type = move_only_function<Signature>;
+
+private:
+	struct slot_t {
+		Key key;
+		function_type function;
+	};
+
+	static constexpr size_t width = _swiss_group::width;
+
+	int8_t * ctrl{nullptr};
+	slot_t * slots{nullptr};
+	size_t capacity{0};
+	size_t count{0};
+	size_t tombstones{0};
+
+	[[no_unique_address]] Hash hasher{};
+	[[no_unique_address]] KeyEqual equal{};
+
+	// std::hash of integers is often identity, the high bits are mixed into the low ones
+	size_t hash_of(const Key & key) const noexcept(noexcept(hasher(key))) {
+		const uint64_t product = static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(product ^ (product >> 32));
+	}
+
+	static int8_t h2_of(size_t hash) noexcept {
+		return static_cast<int8_t>(hash & 0x7F);
+	}
+
+	static size_t h1_of(size_t hash) noexcept {
+		return hash >> 7;
+	}
+
+	struct probe {
+		size_t group;
+		size_t mask;
+		size_t step{0};
+
+		size_t offset() const noexcept {
+			return group * width;
+		}
+
+		void next() noexcept {
+			group = (group + ++step) & mask;
+		}
+	};
+
+	probe probe_for(size_t hash) const noexcept {
+		const size_t mask = capacity / width - 1;
+		return {h1_of(hash) & mask, mask};
+	}
+
+	// index of slot with the key or capacity
+	size_t find_index(const Key & key, size_t hash) const {
+		if (capacity == 0) {
+			return capacity;
+		}
+
+		const int8_t h2 = h2_of(hash);
+
+		for (probe p = probe_for(hash);; p.next()) {
+			const _swiss_group group{ctrl + p.offset()};
+
+			for (uint32_t candidates = group.match(h2); candidates; candidates &= candidates - 1) {
+				const size_t index = p.offset() + static_cast<size_t>(std::countr_zero(candidates));
+				if (equal(slots[index].key, key)) {
+					return index;
+				}
+			}
+
+			if (group.match_empty()) {
+				return capacity;
+			}
+		}
+	}
+
+	// first empty or deleted slot on the probe sequence (there always is one)
+	size_t free_index(size_t hash) const noexcept {
+		for (probe p = probe_for(hash);; p.next()) {
+			const _swiss_group group{ctrl + p.offset()};
+			if (const uint32_t free = group.match_free()) {
+				return p.offset() + static_cast<size_t>(std::countr_zero(free));
+			}
+		}
+	}
+
+	static int8_t * allocate_ctrl(size_t size) {
+		auto * result = static_cast<int8_t *>(::operator new(size, std::align_val_t{width}));
+		std::memset(result, _swiss_group::empty, size);
+		return result;
+	}
+
+	void rehash(size_t new_capacity) {
+		int8_t * new_ctrl = allocate_ctrl(new_capacity);
+		slot_t * new_slots;
+
+		try {
+			new_slots = static_cast<slot_t *>(::operator new(new_capacity * sizeof(slot_t), std::align_val_t{alignof(slot_t)}));
+		} catch (...) {
+			::operator delete(new_ctrl, std::align_val_t{width});
+			throw;
+		}
+
+		int8_t * old_ctrl = std::exchange(ctrl, new_ctrl);
+		slot_t * old_slots = std::exchange(slots, new_slots);
+		const size_t old_capacity = std::exchange(capacity, new_capacity);
+		tombstones = 0;
+
+		for (size_t i = 0; i != old_capacity; ++i) {
+			if (old_ctrl[i] >= 0) {
+				const size_t hash = hash_of(old_slots[i].key);
+				const size_t index = free_index(hash);
+				new (&slots[index]) slot_t{std::move(old_slots[i].key), std::move(old_slots[i].function)};
+				ctrl[index] = h2_of(hash);
+				old_slots[i].~slot_t();
+			}
+		}
+
+		release(old_ctrl, old_slots);
+	}
+
+	static void release(int8_t * c, slot_t * s) noexcept {
+		if (c) {
+			::operator delete(c, std::align_val_t{width});
+			::operator delete(s, std::align_val_t{alignof(slot_t)});
+		}
+	}
+
+	void destroy_all() noexcept {
+		for (size_t i = 0; i != capacity; ++i) {
+			if (ctrl[i] >= 0) {
+				slots[i].~slot_t();
+			}
+		}
+		if (ctrl) {
+			std::memset(ctrl, _swiss_group::empty, capacity);
+		}
+		count = 0;
+		tombstones = 0;
+	}
+
+	static constexpr size_t max_load(size_t slot_count) noexcept {
+		return slot_count - slot_count / 8;
+	}
+
+	static size_t capacity_for(size_t elements) noexcept {
+		size_t result = width;
+		while (max_load(result) < elements) {
+			result *= 2;
+		}
+		return result;
+	}
+
+public:
+	function_map() noexcept = default;
+
+	function_map(function_map && other) noexcept: ctrl{std::exchange(other.ctrl, nullptr)}, slots{std::exchange(other.slots, nullptr)}, capacity{std::exchange(other.capacity, 0)}, count{std::exchange(other.count, 0)}, tombstones{std::exchange(other.tombstones, 0)}, hasher{other.hasher}, equal{other.equal} { }
+
+	function_map & operator=(function_map && other) noexcept {
+		if (this != &other) {
+			destroy_all();
+			release(ctrl, slots);
+			ctrl = std::exchange(other.ctrl, nullptr);
+			slots = std::exchange(other.slots, nullptr);
+			capacity = std::exchange(other.capacity, 0);
+			count = std::exchange(other.count, 0);
+			tombstones = std::exchange(other.tombstones, 0);
+			hasher = other.hasher;
+			equal = other.equal;
+		}
+		return *this;
+	}
+
+	function_map(const function_map &) = delete;
+	function_map & operator=(const function_map &) = delete;
+
+	~function_map() {
+		destroy_all();
+		release(ctrl, slots);
+	}
+
+	size_t size() const noexcept {
+		return count;
+	}
+
+	bool empty() const noexcept {
+		return count == 0;
+	}
+
+	void reserve(size_t elements) {
+		const size_t needed = capacity_for(elements);
+		if (needed > capacity) {
+			rehash(needed);
+		}
+	}
+
+	void clear() noexcept {
+		destroy_all();
+	}
+
+	// nullptr if there is no such key
+	function_type * find(const Key & key) {
+		const size_t index = find_index(key, hash_of(key));
+		return index != capacity ? &slots[index].function : nullptr;
+	}
+
+	const function_type * find(const Key & key) const {
+		const size_t index = find_index(key, hash_of(key));
+		return index != capacity ? &slots[index].function : nullptr;
+	}
+
+	bool contains(const Key & key) const {
+		return find(key) != nullptr;
+	}
+
+	// returns false (and keeps the existing function) if the key is already there
+	bool insert(Key key, function_type function) {
+		const size_t hash = hash_of(key);
+
+		if (find_index(key, hash) != capacity) {
+			return false;
+		}
+
+		// tombstones count towards the load, if they are the reason the table is rehashed in place
+		if (count + tombstones + 1 > max_load(capacity)) {
+			rehash((count + 1) * 2 > max_load(capacity) ? (capacity == 0 ? width : capacity * 2) : capacity);
+		}
+
+		const size_t index = free_index(hash);
+		new (&slots[index]) slot_t{std::move(key), std::move(function)};
+
+		if (ctrl[index] == _swiss_group::deleted) {
+			--tombstones;
+		}
+
+		ctrl[index] = h2_of(hash);
+		++count;
+		return true;
+	}
+
+	void insert_or_assign(Key key, function_type function) {
+		if (function_type * existing = find(key)) {
+			*existing = std::move(function);
+		} else {
+			insert(std::move(key), std::move(function));
+		}
+	}
+
+	bool erase(const Key & key) {
+		const size_t index = find_index(key, hash_of(key));
+
+		if (index == capacity) {
+			return false;
+		}
+
+		slots[index].~slot_t();
+		--count;
+
+		// probes stop at a group with an empty slot anyway, so the slot can become empty again
+		if (_swiss_group{ctrl + index / width * width}.match_empty()) {
+			ctrl[index] = _swiss_group::empty;
+		} else {
+			ctrl[index] = _swiss_group::deleted;
+			++tombstones;
+		}
+
+		return true;
+	}
+
+	// invokes function for the key, returns false if there is none
+	template <typename... Args> bool dispatch(const Key & key, Args &&... args) requires(std::is_invocable_v<function_type &, Args...>) {
+		if (function_type * f = find(key)) {
+			(*f)(std::forward<Args>(args)...);
+			return true;
+		}
+		return false;
+	}
+};
+
+} // namespace hana23
+
+#endif
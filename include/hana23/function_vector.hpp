@@ -0,0 +1,256 @@
+#ifndef HANA23_FUNCTION_VECTOR_HPP
+#define HANA23_FUNCTION_VECTOR_HPP
+
+#include "utility/vector_growth.hpp"
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// sequence of heterogeneous callables stored back to back in one byte buffer: each entry is its
+// vtable pointer followed directly by the callable's state, so `for_each_invoke` walks memory linearly
+
+// callables which aren't nothrow movable or need more than pointer alignment are kept on the heap
+// (the entry holds the owning pointer), offsets of entries are kept aside for random access
+
+// erasing from the middle relocates entries into a new buffer
+
+template <typename> class function_vector;
+
+template <typename Callable> struct _boxed_callable {
+	std::unique_ptr<Callable> ptr;
+
+	template <typename... Args> decltype(auto) operator()(Args &&... args) {
+		return std::invoke(*ptr, std::forward<Args>(args)...);
+	}
+};
+
+template <typename R, typename... Args> class function_vector<R(Args...)> {
+	static constexpr size_t alignment = alignof(void *);
+
+	struct vtable_t {
+		// distance to the next entry
+		size_t stride;
+
+		explicit constexpr vtable_t(size_t s) noexcept: stride{s} { }
+
+		virtual R call(void * obj, Args... args) const = 0;
+		virtual void relocate(void * destination, void * source) const noexcept = 0;
+		virtual void destroy(void * obj) const noexcept = 0;
+	};
+
+	struct header_t {
+		const vtable_t * vtable;
+	};
+
+	static constexpr size_t round_up(size_t size) noexcept {
+		return (size + alignment - 1) & ~(alignment - 1);
+	}
+
+	static constexpr size_t header_size = round_up(sizeof(header_t));
+
+	template <typename Callable> static constexpr bool stored_inline = alignof(Callable) <= alignment && std::is_nothrow_move_constructible_v<Callable>;
+
+	template <typename Callable> using stored_t = std::conditional_t<stored_inline<Callable>, Callable, _boxed_callable<Callable>>;
+
+	template <typename Stored> struct implementation final: vtable_t {
+		constexpr implementation() noexcept: vtable_t{header_size + round_up(sizeof(Stored))} { }
+
+		R call(void * obj, Args... args) const final {
+			return std::invoke(*static_cast<Stored *>(obj), std::forward<Args>(args)...);
+		}
+
+		void relocate(void * destination, void * source) const noexcept final {
+			new (destination) Stored(std::move(*static_cast<Stored *>(source)));
+			static_cast<Stored *>(source)->~Stored();
+		}
+
+		void destroy(void * obj) const noexcept final {
+			static_cast<Stored *>(obj)->~Stored();
+		}
+	};
+
+	template <typename Stored> static constexpr auto vtable_for = implementation<Stored>{};
+
+	std::byte * buffer{nullptr};
+	size_t used{0};
+	size_t capacity{0};
+	std::vector<size_t> offsets{};
+
+	static header_t & header_at(std::byte * entry) noexcept {
+		return *std::launder(reinterpret_cast<header_t *>(entry));
+	}
+
+	static void * object_at(std::byte * entry) noexcept {
+		return entry + header_size;
+	}
+
+	// moves all entries into a new buffer, the skipped one is destroyed instead (relocation during erase
+	// can't be done in place as entries of different sizes would overlap)
+	void reallocate(size_t new_capacity, size_t skipped = static_cast<size_t>(-1)) {
+		auto * next = static_cast<std::byte *>(::operator new(new_capacity));
+		size_t destination = 0;
+
+		for (size_t offset = 0; offset != used;) {
+			const vtable_t * vt = header_at(buffer + offset).vtable;
+
+			if (offset != skipped) {
+				new (next + destination) header_t{vt};
+				vt->relocate(object_at(next + destination), object_at(buffer + offset));
+				destination += vt->stride;
+			} else {
+				vt->destroy(object_at(buffer + offset));
+			}
+
+			offset += vt->stride;
+		}
+
+		::operator delete(buffer);
+		buffer = next;
+		used = destination;
+		capacity = new_capacity;
+	}
+
+	void destroy_all() noexcept {
+		for (size_t offset = 0; offset != used;) {
+			const vtable_t * vt = header_at(buffer + offset).vtable;
+			vt->destroy(object_at(buffer + offset));
+			offset += vt->stride;
+		}
+		used = 0;
+		offsets.clear();
+	}
+
+public:
+	using result_type = R;
+
+	function_vector() noexcept = default;
+
+	function_vector(function_vector && other) noexcept: buffer{std::exchange(other.buffer, nullptr)}, used{std::exchange(other.used, 0)}, capacity{std::exchange(other.capacity, 0)}, offsets{std::move(other.offsets)} { }
+
+	function_vector & operator=(function_vector && other) noexcept {
+		if (this != &other) {
+			destroy_all();
+			::operator delete(buffer);
+			buffer = std::exchange(other.buffer, nullptr);
+			used = std::exchange(other.used, 0);
+			capacity = std::exchange(other.capacity, 0);
+			offsets = std::move(other.offsets);
+		}
+		return *this;
+	}
+
+	function_vector(const function_vector &) = delete;
+	function_vector & operator=(const function_vector &) = delete;
+
+	~function_vector() {
+		destroy_all();
+		::operator delete(buffer);
+	}
+
+	size_t size() const noexcept {
+		return offsets.size();
+	}
+
+	bool empty() const noexcept {
+		return offsets.empty();
+	}
+
+	// bytes used by entries
+	size_t storage_size() const noexcept {
+		return used;
+	}
+
+	void reserve(size_t count, size_t bytes) {
+		offsets.reserve(count);
+		if (bytes > capacity) {
+			reallocate(bytes);
+		}
+	}
+
+	template <typename T, typename... CArgs> void emplace_back(CArgs &&... cargs) requires(std::is_invocable_r_v<R, T &, Args...>) {
+		static_assert(std::is_same_v<std::decay_t<T>, T>);
+
+		using stored = stored_t<T>;
+		constexpr const vtable_t & vt = vtable_for<stored>;
+
+		_reserve_one_more(offsets);
+
+		if (used + vt.stride > capacity) {
+			const size_t doubled = capacity * 2;
+			reallocate(doubled > used + vt.stride ? doubled : used + vt.stride + 256);
+		}
+
+		std::byte * entry = buffer + used;
+
+		if constexpr (stored_inline<T>) {
+			new (object_at(entry)) stored(std::forward<CArgs>(cargs)...);
+		} else {
+			new (object_at(entry)) stored{std::make_unique<T>(std::forward<CArgs>(cargs)...)};
+		}
+
+		// header is written only after the callable was successfully constructed
+		new (entry) header_t{&vt};
+		offsets.push_back(used);
+		used += vt.stride;
+	}
+
+	template <typename F> void push_back(F && f) requires(std::is_invocable_r_v<R, std::decay_t<F> &, Args...>) {
+		emplace_back<std::decay_t<F>>(std::forward<F>(f));
+	}
+
+	// invokes index-th callable
+	R invoke(size_t index, Args... args) {
+		assert(index < offsets.size());
+		std::byte * entry = buffer + offsets[index];
+		return header_at(entry).vtable->call(object_at(entry), std::forward<Args>(args)...);
+	}
+
+	// invokes all callables in order of insertion, arguments are passed to each of them as lvalues
+	void for_each_invoke(Args... args) {
+		for (size_t offset = 0; offset != used;) {
+			std::byte * entry = buffer + offset;
+			const vtable_t * vt = header_at(entry).vtable;
+			vt->call(object_at(entry), args...);
+			offset += vt->stride;
+		}
+	}
+
+	void pop_back() noexcept {
+		assert(!empty());
+		const size_t offset = offsets.back();
+		header_at(buffer + offset).vtable->destroy(object_at(buffer + offset));
+		offsets.pop_back();
+		used = offset;
+	}
+
+	// removes index-th callable, following ones are relocated into a new buffer
+	void erase(size_t index) {
+		assert(index < offsets.size());
+
+		const size_t offset = offsets[index];
+		const size_t removed = header_at(buffer + offset).vtable->stride;
+
+		reallocate(capacity, offset);
+
+		offsets.erase(offsets.begin() + static_cast<std::ptrdiff_t>(index));
+		for (size_t i = index; i != offsets.size(); ++i) {
+			offsets[i] -= removed;
+		}
+	}
+
+	void clear() noexcept {
+		destroy_all();
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef HANA23_FUTURE_HPP
+#define HANA23_FUTURE_HPP
+
+#include "move_only_function.hpp"
+#include "utility/node_pool.hpp"
+#include <atomic>
+#include <exception>
+#include <future>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// one-shot promise/future pair, shared state with the result and both continuation slots is a single
+// (pooled) allocation and a continuation which fits into move_only_function's buffer doesn't allocate
+
+// the continuation is invoked on the thread which completes the promise, or directly inside of
+// `then` if the result is already there, synchronization is one atomic RMW on each side
+
+template <typename T> struct _future_value {
+	using continuation_type = move_only_function<void(T) &&>;
+
+	std::optional<T> value{};
+
+	template <typename... Args> void emplace(Args &&... args) {
+		value.emplace(std::forward<Args>(args)...);
+	}
+
+	void invoke(continuation_type && continuation) {
+		std::move(continuation)(std::move(*value));
+	}
+
+	T take() {
+		return std::move(*value);
+	}
+};
+
+template <> struct _future_value<void> {
+	using continuation_type = move_only_function<void() &&>;
+
+	void emplace() noexcept { }
+
+	void invoke(continuation_type && continuation) {
+		std::move(continuation)();
+	}
+
+	void take() noexcept { }
+};
+
+template <typename T> struct _future_state: _future_value<T> {
+	using continuation_type = typename _future_value<T>::continuation_type;
+	using error_handler_type = move_only_function<void(std::exception_ptr) &&>;
+
+	static constexpr uint32_t has_result = 1;
+	static constexpr uint32_t has_continuation = 2;
+	static constexpr uint32_t has_waiter = 4;
+
+	std::atomic<uint32_t> flags{0};
+	std::atomic<uint32_t> references{1};
+	std::exception_ptr exception{};
+	continuation_type on_value{};
+	error_handler_type on_error{};
+
+	void acquire() noexcept {
+		references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void release() noexcept {
+		if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete this;
+		}
+	}
+
+	void run_continuation() {
+		// handlers are moved out, so they are destroyed even if they throw
+		if (exception) {
+			on_value = nullptr;
+			if (auto handler = std::move(on_error)) {
+				std::move(handler)(exception);
+			}
+		} else {
+			on_error = nullptr;
+			this->invoke(std::move(on_value));
+		}
+	}
+
+	// producer's side, result or exception is already stored
+	void complete() {
+		const uint32_t previous = flags.fetch_or(has_result, std::memory_order_acq_rel);
+
+		if (previous & has_waiter) {
+			flags.notify_all();
+		}
+
+		if (previous & has_continuation) {
+			run_continuation();
+		}
+	}
+
+	// consumer's side, continuation is already stored
+	void attach() {
+		const uint32_t previous = flags.fetch_or(has_continuation, std::memory_order_acq_rel);
+
+		if (previous & has_result) {
+			run_continuation();
+		}
+	}
+
+	bool ready() const noexcept {
+		return flags.load(std::memory_order_acquire) & has_result;
+	}
+
+	void wait() noexcept {
+		uint32_t current = flags.fetch_or(has_waiter, std::memory_order_acq_rel) | has_waiter;
+
+		while (!(current & has_result)) {
+			flags.wait(current, std::memory_order_acquire);
+			current = flags.load(std::memory_order_acquire);
+		}
+	}
+
+	static void * operator new(size_t size) {
+		return _node_pool::allocate(size);
+	}
+
+	static void operator delete(void * ptr, size_t size) noexcept {
+		_node_pool::deallocate(ptr, size);
+	}
+
+	// pool blocks are only aligned for std::max_align_t
+	static void * operator new(size_t size, std::align_val_t alignment) {
+		return ::operator new(size, alignment);
+	}
+
+	static void operator delete(void * ptr, size_t size, std::align_val_t alignment) noexcept {
+		::operator delete(ptr, size, alignment);
+	}
+};
+
+template <typename T> class promise;
+
+template <typename T> class future {
+	friend promise<T>;
+
+	using state_type = _future_state<T>;
+
+	state_type * state{nullptr};
+
+	explicit future(state_type * s) noexcept: state{s} { }
+
+public:
+	using continuation_type = typename state_type::continuation_type;
+	using error_handler_type = typename state_type::error_handler_type;
+
+	future() noexcept = default;
+
+	future(future && other) noexcept: state{std::exchange(other.state, nullptr)} { }
+
+	future & operator=(future && other) noexcept {
+		if (this != &other) {
+			if (state) {
+				state->release();
+			}
+			state = std::exchange(other.state, nullptr);
+		}
+		return *this;
+	}
+
+	future(const future &) = delete;
+	future & operator=(const future &) = delete;
+
+	~future() {
+		if (state) {
+			state->release();
+		}
+	}
+
+	bool valid() const noexcept {
+		return state != nullptr;
+	}
+
+	bool ready() const noexcept {
+		assert(valid());
+		return state->ready();
+	}
+
+	// blocks until the promise is completed
+	void wait() const noexcept {
+		assert(valid());
+		state->wait();
+	}
+
+	// blocks until the promise is completed and returns its value (or rethrows its exception)
+	T get() && {
+		assert(valid());
+		state->wait();
+
+		future self{std::move(*this)};
+
+		if (self.state->exception) {
+			std::rethrow_exception(self.state->exception);
+		}
+
+		return self.state->take();
+	}
+
+	// continuation is invoked with the value, if the promise fails the exception is dropped
+	void then(continuation_type on_value) && {
+		std::move(*this).then(std::move(on_value), nullptr);
+	}
+
+	// exactly one of the handlers is invoked (unless the handler for the outcome is empty)
+	void then(continuation_type on_value, error_handler_type on_error) && {
+		assert(valid());
+
+		future self{std::move(*this)};
+		self.state->on_value = std::move(on_value);
+		self.state->on_error = std::move(on_error);
+		self.state->attach();
+	}
+};
+
+template <typename T> class promise {
+	using state_type = _future_state<T>;
+
+	state_type * state;
+	bool retrieved{false};
+	bool satisfied{false};
+
+	template <typename... Args> void complete(Args &&... args) {
+		assert(state != nullptr && !satisfied);
+		state->emplace(std::forward<Args>(args)...);
+		satisfied = true;
+		state->complete();
+	}
+
+public:
+	promise(): state{new state_type{}} { }
+
+	promise(promise && other) noexcept: state{std::exchange(other.state, nullptr)}, retrieved{other.retrieved}, satisfied{other.satisfied} { }
+
+	promise & operator=(promise && other) noexcept {
+		if (this != &other) {
+			promise previous{std::move(*this)};
+			state = std::exchange(other.state, nullptr);
+			retrieved = other.retrieved;
+			satisfied = other.satisfied;
+		}
+		return *this;
+	}
+
+	promise(const promise &) = delete;
+	promise & operator=(const promise &) = delete;
+
+	// unsatisfied promise completes the future with broken_promise error (a throwing error handler terminates)
+	~promise() {
+		if (!state) {
+			return;
+		}
+
+		if (!satisfied && retrieved) {
+			set_exception(std::make_exception_ptr(std::future_error{std::future_errc::broken_promise}));
+		}
+
+		state->release();
+	}
+
+	// can be called only once
+	future<T> get_future() noexcept {
+		assert(state != nullptr && !retrieved);
+		retrieved = true;
+		state->acquire();
+		return future<T>{state};
+	}
+
+	// waiting continuation is invoked from here
+	template <typename... Args> void set_value(Args &&... args) requires(std::is_void_v<T> ? sizeof...(Args) == 0 : std::is_constructible_v<T, Args...>) {
+		complete(std::forward<Args>(args)...);
+	}
+
+	void set_exception(std::exception_ptr exception) {
+		assert(state != nullptr && !satisfied && exception);
+		satisfied = true;
+		state->exception = std::move(exception);
+		state->complete();
+	}
+};
+
+} // namespace hana23
+
+#endif
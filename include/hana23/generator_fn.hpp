@@ -0,0 +1,136 @@
+#ifndef HANA23_GENERATOR_FN_HPP
+#define HANA23_GENERATOR_FN_HPP
+
+#include "move_only_function.hpp"
+#include <concepts>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+namespace hana23 {
+
+// type-erased pull source which produces elements in batches: one indirect call fills whole span
+// provided by the caller, so the erased call is amortized over the batch instead of paid per element
+
+// a source fills the span from the beginning and returns number of elements written, returning zero
+// means it's exhausted, a source producing one std::optional<T> per call is wrapped in an adapter
+// which calls it directly in a loop
+
+// `next` gives elements one by one from an internal batch, so both ways of reading can be mixed
+
+template <typename F, typename T> concept _batch_source = std::is_invocable_r_v<size_t, F &, std::span<T>>;
+
+template <typename F, typename T> concept _element_source = std::is_invocable_r_v<std::optional<T>, F &>;
+
+template <typename T, typename F> struct _element_source_adapter {
+	F source;
+	bool exhausted{false};
+
+	size_t operator()(std::span<T> batch) {
+		size_t count = 0;
+
+		while (!exhausted && count != batch.size()) {
+			std::optional<T> element = source();
+			if (element) {
+				batch[count++] = std::move(*element);
+			} else {
+				exhausted = true;
+			}
+		}
+
+		return count;
+	}
+};
+
+template <typename T> class generator_fn {
+	static_assert(std::is_default_constructible_v<T> && std::is_move_assignable_v<T>, "batches are preallocated spans");
+
+public:
+	using value_type = T;
+	using source_type = move_only_function<size_t(std::span<T>)>;
+
+	static constexpr size_t default_batch_size = 256;
+
+private:
+	source_type source{};
+
+	// batch used by `next`
+	std::vector<T> buffer{};
+	size_t position{0};
+	size_t count{0};
+	size_t batch_size{default_batch_size};
+
+public:
+	generator_fn() noexcept = default;
+
+	template <typename F> generator_fn(F && f) requires(!std::same_as<std::remove_cvref_t<F>, generator_fn> && _batch_source<std::decay_t<F>, T>): source{std::forward<F>(f)} { }
+
+	template <typename F> generator_fn(F && f) requires(!std::same_as<std::remove_cvref_t<F>, generator_fn> && !_batch_source<std::decay_t<F>, T> && _element_source<std::decay_t<F>, T>): source{_element_source_adapter<T, std::decay_t<F>>{std::forward<F>(f)}} { }
+
+	generator_fn(generator_fn &&) noexcept = default;
+	generator_fn & operator=(generator_fn &&) noexcept = default;
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(source);
+	}
+
+	// size of batches `next` pulls
+	void set_batch_size(size_t size) noexcept {
+		assert(size != 0);
+		batch_size = size;
+	}
+
+	// fills the span from the beginning, returns number of written elements (zero at the end), elements
+	// already pulled by `next` come first
+	size_t next_batch(std::span<T> batch) {
+		assert(source);
+
+		const size_t buffered = count - position;
+		if (buffered != 0) {
+			const size_t n = buffered < batch.size() ? buffered : batch.size();
+			for (size_t i = 0; i != n; ++i) {
+				batch[i] = std::move(buffer[position++]);
+			}
+			return n;
+		}
+
+		return source(batch);
+	}
+
+	std::optional<T> next() {
+		if (position == count) {
+			assert(source);
+
+			buffer.resize(batch_size);
+			// nothing is buffered if the source throws
+			position = 0;
+			count = 0;
+			count = source(buffer);
+
+			if (count == 0) {
+				return std::nullopt;
+			}
+		}
+
+		return std::move(buffer[position++]);
+	}
+
+	// invokes `f` with each remaining element (as rvalue), pulling batches of `batch_size`
+	template <typename F> void for_each(F && f) requires(std::is_invocable_v<F &, T &&>) {
+		std::vector<T> batch(batch_size);
+
+		while (const size_t n = next_batch(batch)) {
+			for (size_t i = 0; i != n; ++i) {
+				f(std::move(batch[i]));
+			}
+		}
+	}
+};
+
+} // namespace hana23
+
+#endif
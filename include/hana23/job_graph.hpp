@@ -0,0 +1,253 @@
+#ifndef HANA23_JOB_GRAPH_HPP
+#define HANA23_JOB_GRAPH_HPP
+
+#include "move_only_function.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// directed acyclic graph of jobs executed on thread_pool, a job runs once all its predecessors finished
+
+// the graph is built once and can be run repeatedly, edges are compacted into one array on the first
+// run after modification and every run only resets in-degree counters
+
+// a job which makes successors ready continues with one of them on the same thread, the rest is
+// posted to the pool (to worker's own deque when posted from a worker, so other workers steal them)
+
+// each job has its pool node allocated by the compaction, so running doesn't allocate, if posting
+// fails anyway (e.g. worker's deque can't grow) the job is run by the thread which made it ready
+
+class job_graph {
+public:
+	using job_id = uint32_t;
+
+private:
+	static constexpr job_id no_job = static_cast<job_id>(-1);
+
+	std::vector<move_only_function<void()>> bodies{};
+	std::vector<std::pair<job_id, job_id>> edges{};
+
+	// compacted successors (CSR), valid when not dirty
+	std::vector<uint32_t> in_degree{};
+	std::vector<size_t> successor_offsets{};
+	std::vector<job_id> successors{};
+	bool dirty{true};
+
+	struct job_node {
+		_external_task_node<thread_pool::node_type> node{};
+		job_graph * graph{nullptr};
+		job_id id{no_job};
+		// next job in the list of jobs which weren't posted
+		job_id deferred{no_job};
+	};
+
+	std::unique_ptr<job_node[]> nodes{};
+
+	// state of current run
+	std::unique_ptr<std::atomic<uint32_t>[]> pending{};
+	std::atomic<size_t> remaining{0};
+	std::atomic<bool> failed{false};
+	std::exception_ptr exception{};
+	thread_pool * pool{nullptr};
+
+	void compact() {
+		const size_t count = bodies.size();
+
+		in_degree.assign(count, 0);
+		successor_offsets.assign(count + 1, 0);
+		successors.resize(edges.size());
+
+		for (const auto & [from, to]: edges) {
+			++successor_offsets[from + 1];
+			++in_degree[to];
+		}
+
+		for (size_t i = 0; i != count; ++i) {
+			successor_offsets[i + 1] += successor_offsets[i];
+		}
+
+		std::vector<size_t> position{successor_offsets.begin(), successor_offsets.end() - 1};
+
+		for (const auto & [from, to]: edges) {
+			successors[position[from]++] = to;
+		}
+
+		// Kahn's algorithm, jobs on a cycle never become ready
+		std::vector<uint32_t> degree{in_degree};
+		std::vector<job_id> ready;
+		ready.reserve(count);
+
+		for (job_id i = 0; i != count; ++i) {
+			if (degree[i] == 0) {
+				ready.push_back(i);
+			}
+		}
+
+		for (size_t i = 0; i != ready.size(); ++i) {
+			for (size_t j = successor_offsets[ready[i]], end = successor_offsets[ready[i] + 1]; j != end; ++j) {
+				if (--degree[successors[j]] == 0) {
+					ready.push_back(successors[j]);
+				}
+			}
+		}
+
+		if (ready.size() != count) {
+			throw std::logic_error("job_graph: dependency cycle");
+		}
+
+		pending.reset(new std::atomic<uint32_t>[count]);
+		nodes.reset(new job_node[count]);
+
+		for (job_id i = 0; i != count; ++i) {
+			nodes[i].graph = this;
+			nodes[i].id = i;
+			nodes[i].node.context = &nodes[i];
+			nodes[i].node.function = [](void * context) {
+				const job_node * n = static_cast<job_node *>(context);
+				n->graph->execute(n->id);
+			};
+		}
+
+		dirty = false;
+	}
+
+	// posts the job or (when that fails) adds it to the list of jobs the caller runs itself
+	void schedule(job_id id, job_id & deferred) noexcept {
+		try {
+			pool->post_node(nodes[id].node);
+		} catch (...) {
+			nodes[id].deferred = deferred;
+			deferred = id;
+		}
+	}
+
+	void execute(job_id id) noexcept {
+		job_id deferred = no_job;
+
+		for (;;) {
+			if (!failed.load(std::memory_order_relaxed)) {
+				try {
+					bodies[id]();
+				} catch (...) {
+					if (!failed.exchange(true, std::memory_order_acq_rel)) {
+						exception = std::current_exception();
+					}
+				}
+			}
+
+			job_id next = no_job;
+
+			for (size_t i = successor_offsets[id], end = successor_offsets[id + 1]; i != end; ++i) {
+				const job_id successor = successors[i];
+
+				if (pending[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+					continue;
+				}
+
+				if (next == no_job) {
+					next = successor;
+				} else {
+					schedule(successor, deferred);
+				}
+			}
+
+			if (next == no_job && deferred != no_job) {
+				next = std::exchange(deferred, nodes[deferred].deferred);
+			}
+
+			// after the last job finishes the graph can be run again or destroyed
+			if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 || next == no_job) {
+				return;
+			}
+
+			id = next;
+		}
+	}
+
+public:
+	job_graph() = default;
+	job_graph(const job_graph &) = delete;
+	job_graph & operator=(const job_graph &) = delete;
+
+	job_id add(move_only_function<void()> body) {
+		assert(body);
+		assert(bodies.size() < no_job);
+
+		bodies.push_back(std::move(body));
+		dirty = true;
+		return static_cast<job_id>(bodies.size() - 1);
+	}
+
+	// `after` will run once `before` finished
+	void precede(job_id before, job_id after) {
+		assert(before < bodies.size() && after < bodies.size());
+
+		edges.emplace_back(before, after);
+		dirty = true;
+	}
+
+	size_t size() const noexcept {
+		return bodies.size();
+	}
+
+	size_t edge_count() const noexcept {
+		return edges.size();
+	}
+
+	// runs all jobs and waits (helping the pool) until they finish, rethrows the first exception
+	// thrown by a job (jobs which were not started yet are skipped after that), throws
+	// std::logic_error without running anything if the dependencies contain a cycle
+	void run(thread_pool & p) {
+		if (dirty) {
+			compact();
+		}
+
+		if (bodies.empty()) {
+			return;
+		}
+
+		pool = &p;
+		failed.store(false, std::memory_order_relaxed);
+		remaining.store(bodies.size(), std::memory_order_relaxed);
+
+		for (size_t i = 0; i != bodies.size(); ++i) {
+			pending[i].store(in_degree[i], std::memory_order_relaxed);
+		}
+
+		job_id deferred = no_job;
+
+		for (job_id i = 0; i != bodies.size(); ++i) {
+			if (in_degree[i] == 0) {
+				schedule(i, deferred);
+			}
+		}
+
+		while (deferred != no_job) {
+			execute(std::exchange(deferred, nodes[deferred].deferred));
+		}
+
+		while (remaining.load(std::memory_order_acquire) != 0) {
+			if (!pool->try_run_one()) {
+				std::this_thread::yield();
+			}
+		}
+
+		if (failed.load(std::memory_order_acquire)) {
+			std::rethrow_exception(std::exchange(exception, nullptr));
+		}
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef HANA23_LAZY_HPP
+#define HANA23_LAZY_HPP
+
+#include "move_only_function.hpp"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+
+namespace hana23 {
+
+// one-time initialization without std::call_once: the initializer is a single move_only_function
+// (usually stored inline), after initialization the check is one acquire load, callers racing with
+// the initialization wait on the atomic state
+
+// the initializer is invoked as rvalue (it's called at most once) and it's moved out of the object
+// before the call, so its captures don't live as long as the object, if it throws the exception is
+// kept and rethrown by every later access (the initializer isn't invoked again)
+
+struct _once_flag {
+	enum state_t : uint8_t { idle, running, done, failed };
+
+	std::atomic<uint8_t> state{idle};
+	// written before the state becomes failed
+	std::exception_ptr error{};
+
+	bool is_done() const noexcept {
+		return state.load(std::memory_order_acquire) == done;
+	}
+
+	bool is_failed() const noexcept {
+		return state.load(std::memory_order_acquire) == failed;
+	}
+
+	// returns true if `f` was invoked by this call, when it returns `f` finished in some thread, rethrows
+	// exception thrown by `f` (in this or any earlier call)
+	template <typename F> bool call(F && f) {
+		uint8_t current = state.load(std::memory_order_acquire);
+
+		while (current != done) {
+			if (current == failed) {
+				std::rethrow_exception(error);
+			} else if (current == running) {
+				state.wait(running, std::memory_order_acquire);
+				current = state.load(std::memory_order_acquire);
+			} else if (state.compare_exchange_weak(current, running, std::memory_order_acquire, std::memory_order_acquire)) {
+				try {
+					std::forward<F>(f)();
+				} catch (...) {
+					error = std::current_exception();
+					state.store(failed, std::memory_order_release);
+					state.notify_all();
+					throw;
+				}
+
+				state.store(done, std::memory_order_release);
+				state.notify_all();
+				return true;
+			}
+		}
+
+		return false;
+	}
+};
+
+template <typename T> class lazy {
+public:
+	using initializer_type = move_only_function<T() &&>;
+
+private:
+	mutable _once_flag flag{};
+	mutable initializer_type initializer;
+
+	union {
+		mutable T value;
+	};
+
+	void initialize() const {
+		flag.call([this] {
+			initializer_type init = std::move(initializer);
+			initializer = nullptr;
+			std::construct_at(std::addressof(value), std::move(init)());
+		});
+	}
+
+public:
+	explicit lazy(initializer_type init): initializer{std::move(init)} {
+		assert(initializer);
+	}
+
+	lazy(const lazy &) = delete;
+	lazy & operator=(const lazy &) = delete;
+
+	~lazy() {
+		if (flag.is_done()) {
+			value.~T();
+		}
+	}
+
+	bool initialized() const noexcept {
+		return flag.is_done();
+	}
+
+	// true when the initializer threw, every access rethrows its exception
+	bool failed() const noexcept {
+		return flag.is_failed();
+	}
+
+	// thread-safe, first caller computes the value
+	T & get() {
+		if (!flag.is_done()) [[unlikely]] {
+			initialize();
+		}
+		return value;
+	}
+
+	const T & get() const {
+		if (!flag.is_done()) [[unlikely]] {
+			initialize();
+		}
+		return value;
+	}
+
+	T & operator*() {
+		return get();
+	}
+
+	const T & operator*() const {
+		return get();
+	}
+
+	T * operator->() {
+		return std::addressof(get());
+	}
+
+	const T * operator->() const {
+		return std::addressof(get());
+	}
+};
+
+template <typename> class once_function;
+
+// callable which runs its function exactly once however many threads call it, calls overlapping
+// with the invocation wait for it to finish
+
+// the function is taken out before it's invoked, if it throws the exception propagates and every
+// later call rethrows it (the function isn't invoked again, its captures may be moved out)
+template <typename... Args> class once_function<void(Args...)> {
+public:
+	using function_type = move_only_function<void(Args...) &&>;
+
+private:
+	_once_flag flag{};
+	function_type function;
+
+public:
+	explicit once_function(function_type f): function{std::move(f)} {
+		assert(function);
+	}
+
+	once_function(const once_function &) = delete;
+	once_function & operator=(const once_function &) = delete;
+
+	// true once the function was invoked, even if it threw
+	bool called() const noexcept {
+		return flag.is_done() || flag.is_failed();
+	}
+
+	bool failed() const noexcept {
+		return flag.is_failed();
+	}
+
+	// returns true if this call invoked the function
+	bool operator()(Args... args) {
+		if (flag.is_done()) {
+			return false;
+		}
+
+		return flag.call([&] {
+			function_type f = std::move(function);
+			function = nullptr;
+			std::move(f)(std::forward<Args>(args)...);
+		});
+	}
+};
+
+} // namespace hana23
+
+#endif
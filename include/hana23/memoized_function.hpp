@@ -0,0 +1,175 @@
+#ifndef HANA23_MEMOIZED_FUNCTION_HPP
+#define HANA23_MEMOIZED_FUNCTION_HPP
+
+#include "move_only_function.hpp"
+#include <bit>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// wrapper of pure function which caches its results in bounded table: the table is split into
+// shards with own lock (chosen by hash, so unrelated calls rarely contend) and each shard is
+// set-associative, a key can only live in one set of `ways` neighbouring slots, lookup scans that
+// set and a full set evicts with CLOCK (slot which wasn't hit since the hand passed it)
+
+// the function isn't called under the lock, so two threads missing the same key at once both call
+// it (it's pure) and the later result replaces the earlier one
+
+// arguments are stored decayed as the key, they need std::hash and ==, results are returned by copy
+
+template <typename... Ts> struct _tuple_hash {
+	size_t operator()(const std::tuple<Ts...> & key) const noexcept {
+		size_t result = 0;
+		std::apply([&](const auto &... element) { ((result ^= std::hash<std::decay_t<decltype(element)>>{}(element) + 0x9E3779B9u + (result << 6) + (result >> 2)), ...); }, key);
+		return result;
+	}
+};
+
+template <typename> class memoized_function;
+
+template <typename R, typename... Args> class memoized_function<R(Args...) const> {
+	static_assert(!std::is_void_v<R> && !std::is_reference_v<R>, "only values can be cached");
+	static_assert(std::is_copy_constructible_v<R>, "cached result is returned by copy");
+
+public:
+	using function_type = move_only_function<R(Args...) const>;
+	using key_type = std::tuple<std::decay_t<Args>...>;
+
+	static constexpr size_t ways = 8;
+
+private:
+	struct slot_t {
+		size_t hash{0};
+		bool referenced{false};
+		std::optional<std::pair<key_type, R>> item{};
+	};
+
+	struct alignas(64) shard_t {
+		std::mutex lock{};
+		std::unique_ptr<slot_t[]> slots{};
+		// clock hand of each set
+		std::unique_ptr<uint8_t[]> hands{};
+	};
+
+	function_type function;
+	std::unique_ptr<shard_t[]> shards;
+	size_t shard_mask;
+	size_t set_mask;
+
+	static size_t hash_of(const key_type & key) noexcept {
+		const uint64_t product = static_cast<uint64_t>(_tuple_hash<std::decay_t<Args>...>{}(key)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(product ^ (product >> 32));
+	}
+
+	shard_t & shard_of(size_t hash) const noexcept {
+		return shards[hash & shard_mask];
+	}
+
+	// index of the first slot of the set
+	size_t set_of(size_t hash) const noexcept {
+		return ((hash >> 16) & set_mask) * ways;
+	}
+
+	static slot_t * lookup(slot_t * set, size_t hash, const key_type & key) {
+		for (size_t i = 0; i != ways; ++i) {
+			if (set[i].item && set[i].hash == hash && set[i].item->first == key) {
+				return &set[i];
+			}
+		}
+		return nullptr;
+	}
+
+	static slot_t & victim(slot_t * set, uint8_t & hand) noexcept {
+		for (size_t i = 0; i != ways; ++i) {
+			if (!set[i].item) {
+				return set[i];
+			}
+		}
+
+		while (set[hand].referenced) {
+			set[hand].referenced = false;
+			hand = static_cast<uint8_t>((hand + 1) % ways);
+		}
+
+		slot_t & result = set[hand];
+		hand = static_cast<uint8_t>((hand + 1) % ways);
+		return result;
+	}
+
+public:
+	// capacity is the number of cached results (rounded up), shards the number of locks
+	explicit memoized_function(function_type f, size_t capacity = 1024, size_t shard_count = 16): function{std::move(f)} {
+		assert(function);
+
+		shard_count = std::bit_ceil(shard_count == 0 ? 1 : shard_count);
+		const size_t sets = std::bit_ceil((capacity + shard_count * ways - 1) / (shard_count * ways));
+
+		shards = std::make_unique<shard_t[]>(shard_count);
+		for (size_t i = 0; i != shard_count; ++i) {
+			shards[i].slots = std::make_unique<slot_t[]>(sets * ways);
+			shards[i].hands = std::make_unique<uint8_t[]>(sets);
+		}
+
+		shard_mask = shard_count - 1;
+		set_mask = sets - 1;
+	}
+
+	memoized_function(const memoized_function &) = delete;
+	memoized_function & operator=(const memoized_function &) = delete;
+
+	size_t capacity() const noexcept {
+		return (shard_mask + 1) * (set_mask + 1) * ways;
+	}
+
+	// thread-safe
+	void clear() {
+		for (size_t i = 0; i <= shard_mask; ++i) {
+			std::lock_guard guard{shards[i].lock};
+			for (size_t j = 0, count = (set_mask + 1) * ways; j != count; ++j) {
+				shards[i].slots[j] = slot_t{};
+			}
+		}
+	}
+
+	// thread-safe, returns cached result or calls the function and caches its result
+	R operator()(Args... args) const {
+		key_type key{args...};
+		const size_t hash = hash_of(key);
+		shard_t & shard = shard_of(hash);
+		const size_t set = set_of(hash);
+
+		{
+			std::lock_guard guard{shard.lock};
+			if (slot_t * hit = lookup(&shard.slots[set], hash, key)) {
+				hit->referenced = true;
+				return hit->item->second;
+			}
+		}
+
+		R result = function(std::forward<Args>(args)...);
+
+		std::lock_guard guard{shard.lock};
+		slot_t * target = lookup(&shard.slots[set], hash, key);
+		if (!target) {
+			target = &victim(&shard.slots[set], shard.hands[set / ways]);
+		}
+
+		target->hash = hash;
+		target->referenced = false;
+		target->item.emplace(std::move(key), result);
+		return result;
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -29,6 +29,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)   no
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -66,7 +67,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)   no
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -88,8 +89,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...)   no
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -222,6 +223,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)   no
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -259,7 +261,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)   no
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -281,8 +283,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...)   no
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -415,6 +417,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -452,7 +455,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -474,8 +477,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -608,6 +611,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -645,7 +649,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -667,8 +671,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -801,6 +805,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  & n
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -838,7 +843,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  & n
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -860,8 +865,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  & n
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -994,6 +999,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  & n
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -1031,7 +1037,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  & n
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -1053,8 +1059,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  & n
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -1187,6 +1193,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -1224,7 +1231,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -1246,8 +1253,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -1380,6 +1387,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -1417,7 +1425,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -1439,8 +1447,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -1573,6 +1581,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -1590,7 +1599,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		// these functions needs to be virtual
 		R call( storage_t & obj, Args... args) const noexcept(false) final {
 			// TODO replace with std::invoke_r
-			return std::invoke(static_cast< Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast< Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -1610,7 +1619,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -1621,7 +1630,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		R call( storage_t & obj, Args... args) const noexcept(false) final {
 			// it's UB to call moved-out function
 			assert(get_pointer(obj) != nullptr);
-			return std::invoke(static_cast< Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast< Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -1632,8 +1641,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -1766,6 +1775,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -1783,7 +1793,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		// these functions needs to be virtual
 		R call( storage_t & obj, Args... args) const noexcept(true) final {
 			// TODO replace with std::invoke_r
-			return std::invoke(static_cast< Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast< Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -1803,7 +1813,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -1814,7 +1824,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		R call( storage_t & obj, Args... args) const noexcept(true) final {
 			// it's UB to call moved-out function
 			assert(get_pointer(obj) != nullptr);
-			return std::invoke(static_cast< Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast< Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -1825,8 +1835,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...)  &&
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -1959,6 +1969,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -1976,7 +1987,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		// these functions needs to be virtual
 		R call(const storage_t & obj, Args... args) const noexcept(false) final {
 			// TODO replace with std::invoke_r
-			return std::invoke(static_cast<const Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast<const Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -1996,7 +2007,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -2007,7 +2018,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		R call(const storage_t & obj, Args... args) const noexcept(false) final {
 			// it's UB to call moved-out function
 			assert(get_pointer(obj) != nullptr);
-			return std::invoke(static_cast<const Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast<const Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -2018,8 +2029,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -2152,6 +2163,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 
 	template <typename Callable> struct short_implementation: vtable_t {
 		static_assert(sizeof(Callable) <= sizeof(storage_t));
+		static_assert(alignof(Callable) <= alignof(storage_t));
 		static_assert(std::is_nothrow_move_constructible_v<Callable>);
 
 		static Callable * get_pointer(storage_t & input) noexcept {
@@ -2169,7 +2181,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		// these functions needs to be virtual
 		R call(const storage_t & obj, Args... args) const noexcept(true) final {
 			// TODO replace with std::invoke_r
-			return std::invoke(static_cast<const Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast<const Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -2189,7 +2201,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		static const callable_ptr & get_pointer(const storage_t & input) noexcept {
-			return *static_cast<const Callable **>(static_cast<const void *>(&input));
+			return *static_cast<const callable_ptr *>(static_cast<const void *>(&input));
 		}
 
 		template <typename... CArgs> static void create_object_with(storage_t & storage, CArgs &&... args) {
@@ -2200,7 +2212,7 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		R call(const storage_t & obj, Args... args) const noexcept(true) final {
 			// it's UB to call moved-out function
 			assert(get_pointer(obj) != nullptr);
-			return std::invoke(static_cast<const Callable &>(*get_pointer(obj)), std::forward<Args>(args)...);
+			return std::invoke(static_cast<const Callable &&>(*get_pointer(obj)), std::forward<Args>(args)...);
 		}
 
 		void move_construct(storage_t & destination, storage_t & source) const final {
@@ -2211,8 +2223,8 @@ template <typename R, typename... Args> class move_only_function<R(Args...) cons
 		}
 
 		void destroy(storage_t & obj) const final {
-			// heap destruction
-			delete get_pointer(obj);
+			// heap destruction (possibly handed over to another thread)
+			_destroy_heap_callable(get_pointer(obj));
 			// and destroy storage of pointer (it doesn't destroy the object, only pointer lifetime)
 			get_pointer(obj).~callable_ptr();
 		}
@@ -0,0 +1,106 @@
+#ifndef HANA23_PIPE_HPP
+#define HANA23_PIPE_HPP
+
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+namespace hana23 {
+
+// `pipe(f, g, h)(args...)` is `h(g(f(args...)))`, `compose(f, g, h)(args...)` is `f(g(h(args...)))`
+
+// all stages are stored next to each other in one object and called from one function, so the chain
+// converted to move_only_function is one allocation (none if it fits the buffer) and one indirect call,
+// piping an already piped object flattens it instead of nesting it
+
+// a stage returning void is followed by a stage called without arguments
+
+template <typename... Stages> class _piped;
+
+template <typename T> struct _is_piped: std::false_type { };
+template <typename... Stages> struct _is_piped<_piped<Stages...>>: std::true_type { };
+
+template <typename... Stages> class _piped {
+	static_assert(sizeof...(Stages) > 0);
+
+	template <typename...> friend class _piped;
+	template <typename... Fs> friend auto pipe(Fs &&...);
+
+	[[no_unique_address]] std::tuple<Stages...> stages;
+
+	template <size_t I, typename Self, typename... Args> static decltype(auto) call(Self && self, Args &&... args) {
+		// each stage is extracted only once, so forwarding self repeatedly is fine
+		using stage_t = decltype(std::get<I>(std::forward<Self>(self).stages));
+
+		if constexpr (I + 1 == sizeof...(Stages)) {
+			return std::invoke(std::get<I>(std::forward<Self>(self).stages), std::forward<Args>(args)...);
+		} else if constexpr (std::is_void_v<std::invoke_result_t<stage_t, Args...>>) {
+			std::invoke(std::get<I>(std::forward<Self>(self).stages), std::forward<Args>(args)...);
+			return call<I + 1>(std::forward<Self>(self));
+		} else {
+			return call<I + 1>(std::forward<Self>(self), std::invoke(std::get<I>(std::forward<Self>(self).stages), std::forward<Args>(args)...));
+		}
+	}
+
+	template <typename F> static auto stages_of(F && f) {
+		if constexpr (_is_piped<std::remove_cvref_t<F>>::value) {
+			return std::forward<F>(f).stages;
+		} else {
+			return std::tuple<std::decay_t<F>>(std::forward<F>(f));
+		}
+	}
+
+	template <typename Tuple, size_t... Idx> static auto from_tuple(Tuple && tuple, std::index_sequence<Idx...>) {
+		return _piped<std::tuple_element_t<Idx, std::remove_cvref_t<Tuple>>...>{std::in_place, std::get<Idx>(std::forward<Tuple>(tuple))...};
+	}
+
+	template <typename... Fs> static auto make(Fs &&... fs) {
+		auto all = std::tuple_cat(stages_of(std::forward<Fs>(fs))...);
+		return from_tuple(std::move(all), std::make_index_sequence<std::tuple_size_v<decltype(all)>>{});
+	}
+
+public:
+	template <typename... Args> constexpr explicit _piped(std::in_place_t, Args &&... args): stages(std::forward<Args>(args)...) { }
+
+	template <typename... Args> decltype(auto) operator()(Args &&... args) & {
+		return call<0>(*this, std::forward<Args>(args)...);
+	}
+
+	template <typename... Args> decltype(auto) operator()(Args &&... args) const & {
+		return call<0>(*this, std::forward<Args>(args)...);
+	}
+
+	template <typename... Args> decltype(auto) operator()(Args &&... args) && {
+		return call<0>(std::move(*this), std::forward<Args>(args)...);
+	}
+
+	// appends a stage
+	template <typename F> auto then(F && f) && {
+		return make(std::move(*this), std::forward<F>(f));
+	}
+
+	template <typename F> auto then(F && f) const & {
+		return make(*this, std::forward<F>(f));
+	}
+};
+
+template <typename... Fs> auto pipe(Fs &&... fs) {
+	static_assert(sizeof...(Fs) > 0, "pipe needs at least one stage");
+	return _piped<int>::make(std::forward<Fs>(fs)...);
+}
+
+template <typename... Fs> auto compose(Fs &&... fs) {
+	static_assert(sizeof...(Fs) > 0, "compose needs at least one stage");
+
+	// forward as references in reverse order
+	auto refs = std::forward_as_tuple(std::forward<Fs>(fs)...);
+	return [&]<size_t... Idx>(std::index_sequence<Idx...>) {
+		return pipe(std::get<sizeof...(Fs) - 1 - Idx>(std::move(refs))...);
+	}(std::make_index_sequence<sizeof...(Fs)>{});
+}
+
+} // namespace hana23
+
+#endif
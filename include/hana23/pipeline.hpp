@@ -0,0 +1,480 @@
+#ifndef HANA23_PIPELINE_HPP
+#define HANA23_PIPELINE_HPP
+
+#include "executor.hpp"
+#include "move_only_function.hpp"
+#include "utility/bounded_queue.hpp"
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// bounded dataflow pipeline: stages (move_only_functions) are connected by lock-free bounded queues
+// of batches, a stage takes a whole batch from its input and emits into an output batch which is
+// handed over when full (or when the stage runs out of input), so queue traffic and wakeups are per
+// batch, not per element
+
+// full queue doesn't block a stage, its output batches wait in the emitter and the stage doesn't take
+// more input until they are handed over, so the same stage can run on its own thread (sleeping on an
+// atomic) or as task on an executor (rescheduled when there is input or space again), pushing into
+// the pipeline blocks while the first queue is full
+
+// the first exception thrown by a stage is rethrown from `wait`, after it the remaining elements are
+// dropped, only one thread can push into the pipeline
+
+struct _pipeline_core;
+
+struct _pipeline_node {
+	enum class status { progressed, idle, finished };
+
+	_pipeline_core * core;
+	// stage running on executor, otherwise it runs on own thread (or it's the feeding thread), set
+	// when the pipeline starts
+	bool pooled{false};
+
+	// changes on each wakeup, so a wakeup between a check and sleeping isn't lost
+	std::atomic<uint32_t> signal{0};
+	// pooled node only, set while it's posted or running (and forever when finished)
+	std::atomic<bool> scheduled{false};
+
+	explicit _pipeline_node(_pipeline_core * c) noexcept: core{c} { }
+
+	virtual ~_pipeline_node() = default;
+
+	// one batch of work
+	virtual status step() {
+		return status::finished;
+	}
+
+	void wake();
+	void run_thread();
+	void run_task();
+	void post_task();
+	void finish() noexcept;
+};
+
+struct _pipeline_core: std::enable_shared_from_this<_pipeline_core> {
+	// empty when stages have own threads
+	move_only_function<void(move_only_function<void() &&>)> post{};
+
+	const size_t batch_size;
+	const size_t queue_capacity;
+
+	std::vector<std::shared_ptr<void>> links{};
+	std::unique_ptr<_pipeline_node> source{};
+	// stages and sink
+	std::vector<std::unique_ptr<_pipeline_node>> nodes{};
+	std::vector<std::thread> threads{};
+
+	// nodes which haven't finished yet
+	std::atomic<size_t> running{0};
+
+	std::atomic<bool> failed{false};
+	std::exception_ptr exception{};
+
+	_pipeline_core(size_t batch, size_t capacity) noexcept: batch_size{batch}, queue_capacity{capacity} { }
+
+	void fail() noexcept {
+		if (!failed.exchange(true, std::memory_order_acq_rel)) {
+			exception = std::current_exception();
+		}
+	}
+};
+
+inline void _pipeline_node::wake() {
+	signal.fetch_add(1, std::memory_order_seq_cst);
+
+	if (!pooled) {
+		signal.notify_one();
+	} else if (!scheduled.exchange(true, std::memory_order_seq_cst)) {
+		post_task();
+	}
+}
+
+inline void _pipeline_node::post_task() {
+	// the task keeps the pipeline alive, it can be still running when the last node finished
+	core->post([keep = core->shared_from_this(), this]() mutable { run_task(); });
+}
+
+inline void _pipeline_node::finish() noexcept {
+	if (core->running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		core->running.notify_all();
+	}
+}
+
+inline void _pipeline_node::run_thread() {
+	for (;;) {
+		const uint32_t seen = signal.load(std::memory_order_acquire);
+
+		switch (step()) {
+		case status::progressed:
+			break;
+		case status::idle:
+			signal.wait(seen, std::memory_order_acquire);
+			break;
+		case status::finished:
+			finish();
+			return;
+		}
+	}
+}
+
+inline void _pipeline_node::run_task() {
+	// batches processed before the task gives way to other tasks of the executor
+	constexpr size_t budget = 16;
+
+	for (size_t processed = 0;;) {
+		const uint32_t seen = signal.load(std::memory_order_seq_cst);
+
+		switch (step()) {
+		case status::progressed:
+			if (++processed == budget) {
+				post_task();
+				return;
+			}
+			break;
+		case status::idle:
+			scheduled.store(false, std::memory_order_seq_cst);
+			// a wakeup which came before clearing the flag didn't post
+			if (signal.load(std::memory_order_seq_cst) == seen || scheduled.exchange(true, std::memory_order_seq_cst)) {
+				return;
+			}
+			break;
+		case status::finished:
+			// scheduled stays set, so it's never posted again
+			finish();
+			return;
+		}
+	}
+}
+
+template <typename T> struct _pipeline_link {
+	_bounded_queue<std::vector<T>> queue;
+	// producer won't push anymore
+	std::atomic<bool> closed{false};
+
+	explicit _pipeline_link(size_t capacity): queue{capacity} { }
+};
+
+template <typename In, typename Out> class pipeline_builder;
+template <typename In> class pipeline;
+
+// output of a stage, collects emitted elements into batches
+template <typename T> class emitter {
+	template <typename, typename> friend class pipeline_builder;
+	template <typename> friend class pipeline;
+	template <typename, typename> friend struct _pipeline_stage;
+	template <typename> friend struct _pipeline_source;
+
+	_pipeline_link<T> * link;
+	_pipeline_node * consumer{nullptr};
+	size_t batch_size;
+
+	std::vector<T> batch{};
+	// full batches which didn't fit into the queue, in order
+	std::vector<std::vector<T>> pending{};
+
+	emitter(_pipeline_link<T> * l, size_t size) noexcept: link{l}, batch_size{size} { }
+
+	void seal() {
+		if (!batch.empty()) {
+			pending.push_back(std::move(batch));
+			batch = {};
+		}
+	}
+
+	// returns false if some batches are still pending
+	bool hand_over() {
+		size_t count = 0;
+
+		// queue leaves the batch untouched when full
+		while (count != pending.size() && link->queue.try_push(std::move(pending[count]))) {
+			++count;
+		}
+
+		if (count != 0) {
+			pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(count));
+			consumer->wake();
+		}
+
+		return pending.empty();
+	}
+
+	void close() {
+		link->closed.store(true, std::memory_order_release);
+		consumer->wake();
+	}
+
+public:
+	emitter(const emitter &) = delete;
+	emitter & operator=(const emitter &) = delete;
+
+	void operator()(T value) {
+		if (batch.empty()) {
+			batch.reserve(batch_size);
+		}
+
+		batch.push_back(std::move(value));
+
+		if (batch.size() == batch_size) {
+			seal();
+			hand_over();
+		}
+	}
+};
+
+template <typename In, typename Out> struct _pipeline_stage final: _pipeline_node {
+	move_only_function<void(In &&, emitter<Out> &)> function;
+	_pipeline_link<In> * input;
+	_pipeline_node * producer;
+	emitter<Out> output;
+
+	_pipeline_stage(_pipeline_core * c, move_only_function<void(In &&, emitter<Out> &)> f, _pipeline_link<In> * in, _pipeline_node * p, _pipeline_link<Out> * out): _pipeline_node{c}, function{std::move(f)}, input{in}, producer{p}, output{out, c->batch_size} { }
+
+	status step() final {
+		if (!output.hand_over()) {
+			return status::idle;
+		}
+
+		// closed is read first, so empty queue after it means there is nothing more
+		const bool closed = input->closed.load(std::memory_order_acquire);
+		std::vector<In> batch;
+
+		if (input->queue.try_pop(batch)) {
+			producer->wake();
+
+			if (!core->failed.load(std::memory_order_relaxed)) {
+				try {
+					for (In & value: batch) {
+						function(std::move(value), output);
+					}
+				} catch (...) {
+					core->fail();
+				}
+			}
+
+			output.hand_over();
+			return status::progressed;
+		}
+
+		// partial batch isn't kept while waiting for more input
+		output.seal();
+
+		if (!output.hand_over() || !closed) {
+			return status::idle;
+		}
+
+		output.close();
+		return status::finished;
+	}
+};
+
+template <typename In> struct _pipeline_sink final: _pipeline_node {
+	move_only_function<void(In &&)> function;
+	_pipeline_link<In> * input;
+	_pipeline_node * producer;
+
+	_pipeline_sink(_pipeline_core * c, move_only_function<void(In &&)> f, _pipeline_link<In> * in, _pipeline_node * p): _pipeline_node{c}, function{std::move(f)}, input{in}, producer{p} { }
+
+	status step() final {
+		const bool closed = input->closed.load(std::memory_order_acquire);
+		std::vector<In> batch;
+
+		if (input->queue.try_pop(batch)) {
+			producer->wake();
+
+			if (!core->failed.load(std::memory_order_relaxed)) {
+				try {
+					for (In & value: batch) {
+						function(std::move(value));
+					}
+				} catch (...) {
+					core->fail();
+				}
+			}
+
+			return status::progressed;
+		}
+
+		return closed ? status::finished : status::idle;
+	}
+};
+
+// the feeding thread, it's only woken when the first queue has space again
+template <typename In> struct _pipeline_source final: _pipeline_node {
+	emitter<In> output;
+
+	_pipeline_source(_pipeline_core * c, _pipeline_link<In> * out): _pipeline_node{c}, output{out, c->batch_size} { }
+};
+
+// builds the chain of stages from the input type `In`, `Out` is the output type of the last stage, `sink`
+// finishes the chain and starts the pipeline
+template <typename In, typename Out = In> class pipeline_builder {
+	template <typename, typename> friend class pipeline_builder;
+
+	std::shared_ptr<_pipeline_core> core;
+	_pipeline_source<In> * source;
+
+	// the last stage (or the source) and its output
+	_pipeline_node * tail;
+	emitter<Out> * tail_output;
+
+	pipeline_builder(std::shared_ptr<_pipeline_core> c, _pipeline_source<In> * s, _pipeline_node * t, emitter<Out> * o) noexcept: core{std::move(c)}, source{s}, tail{t}, tail_output{o} { }
+
+	template <typename T> _pipeline_link<T> * make_link() {
+		auto link = std::make_shared<_pipeline_link<T>>(core->queue_capacity);
+		core->links.push_back(link);
+		return link.get();
+	}
+
+	template <typename Node> Node * append(std::unique_ptr<Node> node) {
+		Node * result = node.get();
+		core->nodes.push_back(std::move(node));
+		tail_output->consumer = result;
+		return result;
+	}
+
+	pipeline<In> start() {
+		core->running.store(core->nodes.size(), std::memory_order_relaxed);
+
+		if (core->post) {
+			for (auto & node: core->nodes) {
+				node->pooled = true;
+			}
+		} else {
+			core->threads.reserve(core->nodes.size());
+			for (auto & node: core->nodes) {
+				core->threads.emplace_back([n = node.get()] { n->run_thread(); });
+			}
+		}
+
+		return pipeline<In>{std::move(core), source};
+	}
+
+public:
+	static constexpr size_t default_batch_size = 64;
+	static constexpr size_t default_queue_capacity = 16;
+
+	// queue capacity is in batches
+	explicit pipeline_builder(size_t batch_size = default_batch_size, size_t queue_capacity = default_queue_capacity) requires(std::is_same_v<In, Out>): core{std::make_shared<_pipeline_core>(batch_size, queue_capacity)} {
+		assert(batch_size != 0);
+
+		auto node = std::make_unique<_pipeline_source<In>>(core.get(), make_link<In>());
+		source = node.get();
+		tail = node.get();
+		tail_output = &node->output;
+		core->source = std::move(node);
+	}
+
+	// appends stage emitting any number of `Next` elements for each input element
+	template <typename Next> pipeline_builder<In, Next> stage(move_only_function<void(Out &&, emitter<Next> &)> f) && {
+		assert(f);
+
+		auto * node = append(std::make_unique<_pipeline_stage<Out, Next>>(core.get(), std::move(f), tail_output->link, tail, make_link<Next>()));
+		return {std::move(core), source, node, &node->output};
+	}
+
+	// finishes the pipeline, each stage runs on its own thread
+	pipeline<In> sink(move_only_function<void(Out &&)> f) && {
+		assert(f);
+
+		append(std::make_unique<_pipeline_sink<Out>>(core.get(), std::move(f), tail_output->link, tail));
+		return start();
+	}
+
+	// finishes the pipeline, stages run as tasks of the executor (which must outlive the pipeline)
+	template <executor Executor> pipeline<In> sink(move_only_function<void(Out &&)> f, Executor & ex) && {
+		core->post = [&ex](move_only_function<void() &&> task) { ex.post(std::move(task)); };
+		return std::move(*this).sink(std::move(f));
+	}
+};
+
+// running pipeline, elements pushed into it are batched too, `flush` hands over the partial batch
+template <typename In> class pipeline {
+	template <typename, typename> friend class pipeline_builder;
+
+	std::shared_ptr<_pipeline_core> core;
+	_pipeline_source<In> * source;
+	bool closed{false};
+
+	pipeline(std::shared_ptr<_pipeline_core> c, _pipeline_source<In> * s) noexcept: core{std::move(c)}, source{s} { }
+
+	// blocks while the first queue is full
+	void hand_over() {
+		while (!source->output.hand_over()) {
+			const uint32_t seen = source->signal.load(std::memory_order_acquire);
+
+			if (source->output.hand_over()) {
+				return;
+			}
+
+			source->signal.wait(seen, std::memory_order_acquire);
+		}
+	}
+
+	void join() noexcept {
+		for (size_t count; (count = core->running.load(std::memory_order_acquire)) != 0;) {
+			core->running.wait(count, std::memory_order_acquire);
+		}
+
+		for (std::thread & t: core->threads) {
+			if (t.joinable()) {
+				t.join();
+			}
+		}
+	}
+
+public:
+	pipeline(pipeline &&) noexcept = default;
+	pipeline & operator=(pipeline &&) = delete;
+
+	// closes the pipeline and waits for it, a stage exception is lost
+	~pipeline() {
+		if (core) {
+			close();
+			join();
+		}
+	}
+
+	void push(In value) {
+		assert(!closed);
+		source->output(std::move(value));
+		hand_over();
+	}
+
+	void flush() {
+		source->output.seal();
+		hand_over();
+	}
+
+	// no more elements will be pushed
+	void close() {
+		if (!closed) {
+			flush();
+			source->output.close();
+			closed = true;
+		}
+	}
+
+	// closes the pipeline and waits until all elements went through, rethrows stage exception
+	void wait() {
+		close();
+		join();
+
+		if (core->exception) {
+			std::rethrow_exception(core->exception);
+		}
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef HANA23_PRIORITY_EXECUTOR_HPP
+#define HANA23_PRIORITY_EXECUTOR_HPP
+
+#include "utility/task_node.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// executor ordering tasks by priority level (0 is most urgent) and then by deadline,
+// tasks with the same deadline run in submission order
+
+// submission is a lock-free push into per-level stack, consumers move submitted tasks
+// into per-level intrusive pairing heap (O(1) insert, O(log n) amortized pop)
+
+template <size_t Levels = 4> class priority_executor {
+	static_assert(Levels > 0);
+
+public:
+	using clock = std::chrono::steady_clock;
+	using time_point = clock::time_point;
+
+	static constexpr size_t levels = Levels;
+	static constexpr size_t default_level = Levels - 1;
+
+private:
+	struct node: _task_node<> {
+		using task_base = _task_node<>;
+		using task_base::task_base;
+
+		node * next{nullptr};
+		node * child{nullptr};
+		time_point deadline{};
+		uint64_t sequence{0};
+
+		friend bool operator<(const node & lhs, const node & rhs) noexcept {
+			return lhs.deadline < rhs.deadline || (lhs.deadline == rhs.deadline && lhs.sequence < rhs.sequence);
+		}
+	};
+
+	// pairing heap (siblings are linked with `next`)
+
+	static node * meld(node * a, node * b) noexcept {
+		if (!a) return b;
+		if (!b) return a;
+		if (*b < *a) std::swap(a, b);
+		b->next = a->child;
+		a->child = b;
+		return a;
+	}
+
+	static node * merge_pairs(node * first) noexcept {
+		// first pass: meld neighbours left to right, collect results reversed
+		node * reversed = nullptr;
+		while (first) {
+			node * a = first;
+			node * b = a->next;
+			first = b ? b->next : nullptr;
+			a->next = nullptr;
+			if (b) b->next = nullptr;
+			node * m = meld(a, b);
+			m->next = reversed;
+			reversed = m;
+		}
+
+		// second pass: meld right to left
+		node * result = nullptr;
+		while (reversed) {
+			node * m = reversed;
+			reversed = m->next;
+			m->next = nullptr;
+			result = meld(result, m);
+		}
+
+		return result;
+	}
+
+	std::array<std::atomic<node *>, Levels> submitted{};
+	std::atomic<uint64_t> sequence{0};
+
+	std::mutex mutex;
+	std::array<node *, Levels> heaps{};
+
+	// needs to be called with mutex locked
+	void collect_submitted() noexcept {
+		for (size_t i = 0; i != Levels; ++i) {
+			if (submitted[i].load(std::memory_order_relaxed) == nullptr) {
+				continue;
+			}
+
+			node * current = submitted[i].exchange(nullptr, std::memory_order_acquire);
+
+			while (current) {
+				node * next = current->next;
+				current->next = nullptr;
+				heaps[i] = meld(heaps[i], current);
+				current = next;
+			}
+		}
+	}
+
+	node * pop() noexcept {
+		std::lock_guard lock{mutex};
+		collect_submitted();
+
+		for (node *& root: heaps) {
+			if (root) {
+				node * result = root;
+				root = merge_pairs(result->child);
+				result->child = nullptr;
+				return result;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static void destroy_all(node * stack) noexcept {
+		// heap can be arbitrarily deep, children are spliced into the list instead of recursion
+		while (stack) {
+			node * current = stack;
+			stack = current->next;
+
+			if (node * child = current->child) {
+				node * tail = child;
+				while (tail->next) tail = tail->next;
+				tail->next = stack;
+				stack = child;
+			}
+
+			current->destroy();
+		}
+	}
+
+	void submit(size_t level, time_point deadline, node * n) noexcept {
+		assert(level < Levels);
+
+		n->child = nullptr;
+		n->deadline = deadline;
+		n->sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+
+		auto & head = submitted[level];
+		n->next = head.load(std::memory_order_relaxed);
+		while (!head.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) { }
+	}
+
+public:
+	priority_executor() noexcept = default;
+	priority_executor(const priority_executor &) = delete;
+	priority_executor & operator=(const priority_executor &) = delete;
+
+	// pending tasks are destroyed without being invoked
+	~priority_executor() {
+		for (auto & head: submitted) {
+			destroy_all(head.load(std::memory_order_acquire));
+		}
+		for (node * root: heaps) {
+			destroy_all(root);
+		}
+	}
+
+	template <typename F> void post(size_t level, time_point deadline, F && f) requires _is_task_for<F> {
+		submit(level, deadline, _make_task_node<node>(std::forward<F>(f)));
+	}
+
+	template <typename F> void post(size_t level, F && f) requires _is_task_for<F> {
+		post(level, time_point::max(), std::forward<F>(f));
+	}
+
+	template <typename F> void post(F && f) requires _is_task_for<F> {
+		post(default_level, time_point::max(), std::forward<F>(f));
+	}
+
+	using node_type = node;
+
+	// queues node owned by the caller (with default level), it must stay alive until it's invoked
+	void post_node(node_type & n) noexcept {
+		submit(default_level, time_point::max(), &n);
+	}
+
+	// runs most urgent task, returns false if there was nothing to run
+	bool run_one() {
+		node * n = pop();
+
+		if (!n) {
+			return false;
+		}
+
+		std::move(*n)();
+		return true;
+	}
+
+	// runs tasks until the executor is empty (including tasks posted meanwhile)
+	size_t poll() {
+		size_t count = 0;
+		while (run_one()) {
+			++count;
+		}
+		return count;
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -2,6 +2,13 @@ function(move_only_function)
 	set(result "")
 	
 	function(generate CV REF NOEXCEPT)
+		# callable is invoked as rvalue only for && qualified signatures
+		if(REF STREQUAL "&&")
+			set(INV_REF "&&")
+		else()
+			set(INV_REF "&")
+		endif()
+
 		set(TEMP_FILE "move_only_function.tmp")
 		configure_file("${SOURCE_DIRECTORY}/templates/move_only_function.in" ${TEMP_FILE})
 		file(READ ${TEMP_FILE} content)
@@ -0,0 +1,184 @@
+#ifndef HANA23_SIGNAL_HPP
+#define HANA23_SIGNAL_HPP
+
+#include "move_only_function.hpp"
+#include "utility/epoch.hpp"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// signal with lock-free emission: slots are read through an immutable snapshot (contiguous array of
+// slot pointers), connect/disconnect build and publish a new snapshot under a writer lock and the old
+// one (and a disconnected slot) is reclaimed through epoch-based reclamation
+
+// slots are move-only so they can't be copied into the next snapshot, each one is allocated once and
+// snapshots only refer to them
+
+// a slot disconnected during emission can still be invoked by emissions which already have the old
+// snapshot, the signal must not be destroyed while it's being emitted
+
+template <typename> class signal;
+
+template <typename... Args> class signal<void(Args...)> {
+public:
+	using slot_type = move_only_function<void(Args...) const>;
+
+	// identifier of connected slot
+	enum class connection : uint64_t {};
+
+private:
+	struct slot_node {
+		connection id;
+		slot_type slot;
+	};
+
+	struct snapshot {
+		size_t count;
+
+		slot_node ** slots() noexcept {
+			return reinterpret_cast<slot_node **>(this + 1);
+		}
+
+		static snapshot * create(size_t count) {
+			void * memory = ::operator new(sizeof(snapshot) + count * sizeof(slot_node *));
+			return new (memory) snapshot{count};
+		}
+
+		static void operator delete(void * ptr) noexcept {
+			::operator delete(ptr);
+		}
+	};
+
+	static_assert(alignof(snapshot) >= alignof(slot_node *));
+
+	std::atomic<snapshot *> current{nullptr};
+
+	std::mutex writer{};
+	uint64_t next_id{0};
+
+	void publish(snapshot * next) {
+		if (snapshot * previous = current.exchange(next, std::memory_order_seq_cst)) {
+			_epoch_domain::domain().retire(previous);
+		}
+	}
+
+public:
+	signal() = default;
+
+	signal(const signal &) = delete;
+	signal & operator=(const signal &) = delete;
+
+	~signal() {
+		if (snapshot * s = current.load(std::memory_order_relaxed)) {
+			for (size_t i = 0; i != s->count; ++i) {
+				delete s->slots()[i];
+			}
+			delete s;
+		}
+	}
+
+	connection connect(slot_type slot) {
+		std::lock_guard lock{writer};
+
+		auto * node = new slot_node{static_cast<connection>(++next_id), std::move(slot)};
+		snapshot * previous = current.load(std::memory_order_relaxed);
+		const size_t count = previous ? previous->count : 0;
+
+		snapshot * next;
+		try {
+			next = snapshot::create(count + 1);
+		} catch (...) {
+			delete node;
+			throw;
+		}
+
+		for (size_t i = 0; i != count; ++i) {
+			next->slots()[i] = previous->slots()[i];
+		}
+		next->slots()[count] = node;
+
+		publish(next);
+		return node->id;
+	}
+
+	// returns false if the slot is not connected
+	bool disconnect(connection id) {
+		std::lock_guard lock{writer};
+
+		snapshot * previous = current.load(std::memory_order_relaxed);
+		const size_t count = previous ? previous->count : 0;
+
+		size_t index = 0;
+		while (index != count && previous->slots()[index]->id != id) {
+			++index;
+		}
+
+		if (index == count) {
+			return false;
+		}
+
+		slot_node * node = previous->slots()[index];
+		snapshot * next = count == 1 ? nullptr : snapshot::create(count - 1);
+
+		for (size_t i = 0, j = 0; i != count; ++i) {
+			if (i != index) {
+				next->slots()[j++] = previous->slots()[i];
+			}
+		}
+
+		publish(next);
+		_epoch_domain::domain().retire(node);
+		return true;
+	}
+
+	// number of connected slots
+	size_t size() const {
+		_epoch_domain::guard guard;
+		const snapshot * s = current.load(std::memory_order_seq_cst);
+		return s ? s->count : 0;
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	// rvalue reference parameters are forwarded (as with other type-erased invokers), other
+	// parameters are passed as lvalues, so a by-value argument isn't moved out by the first slot
+	template <typename Arg> static decltype(auto) pass(std::remove_reference_t<Arg> & arg) noexcept {
+		if constexpr (std::is_rvalue_reference_v<Arg>) {
+			return std::move(arg);
+		} else {
+			return (arg);
+		}
+	}
+
+	// invokes slots in order of connecting without taking any lock, each slot gets the same arguments,
+	// so an rvalue reference argument must not be moved from by more than one slot
+	void emit(Args... args) const {
+		_epoch_domain::guard guard;
+
+		snapshot * s = current.load(std::memory_order_seq_cst);
+		if (!s) {
+			return;
+		}
+
+		slot_node ** slots = s->slots();
+		for (size_t i = 0, count = s->count; i != count; ++i) {
+			slots[i]->slot(pass<Args>(args)...);
+		}
+	}
+
+	void operator()(Args... args) const {
+		emit(std::forward<Args>(args)...);
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef HANA23_STRAND_HPP
+#define HANA23_STRAND_HPP
+
+#include "executor.hpp"
+#include "utility/mpsc_queue.hpp"
+#include "utility/task_node.hpp"
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <cstddef>
+
+namespace hana23 {
+
+// serializes tasks on top of another executor, at most one of them runs at any time and in submission order
+
+// tasks are linked through intrusive MPSC queue, each task is a single node allocation, the underlying
+// executor is only asked to run the strand when it transitions from idle to busy (or after `batch_size`
+// tasks, so the strand doesn't monopolize a worker)
+
+// strand must outlive all its pending tasks (`wait_idle` waits for them), destruction waits only for
+// the activation currently running on the executor to return, tasks left at destruction are
+// destroyed without invoking
+
+template <executor Executor> class strand {
+	struct node: _task_node<>, _mpsc_hook {
+		using task_base = _task_node<>;
+		using task_base::task_base;
+	};
+
+	Executor & underlying;
+	_mpsc_queue<node> queue{};
+	std::atomic<size_t> pending{0};
+	// activations inside of run_pending, leaving it is their last access to the strand
+	std::atomic<size_t> active{0};
+
+	void schedule() {
+		underlying.post([this] { run_pending(); });
+	}
+
+	void run_pending() {
+		active.fetch_add(1, std::memory_order_relaxed);
+
+		struct leave_t {
+			std::atomic<size_t> & active;
+
+			~leave_t() {
+				active.fetch_sub(1, std::memory_order_release);
+			}
+		} leave{active};
+
+		for (size_t executed = 1;; ++executed) {
+			// counter was increased after push, so the node is there (possibly still being linked)
+			node * n = queue.pop();
+
+			try {
+				std::move(*n)();
+			} catch (...) {
+				if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+					schedule();
+				}
+				throw;
+			}
+
+			if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				return;
+			}
+
+			if (executed == batch_size) {
+				schedule();
+				return;
+			}
+		}
+	}
+
+public:
+	static constexpr size_t batch_size = 64;
+
+	explicit strand(Executor & ex) noexcept: underlying{ex} { }
+
+	strand(const strand &) = delete;
+	strand & operator=(const strand &) = delete;
+
+	~strand() {
+		while (active.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+
+		while (node * n = queue.try_pop()) {
+			n->destroy();
+		}
+	}
+
+	template <typename F> void post(F && f) requires _is_task_for<F> {
+		post_node(*_make_task_node<node>(std::forward<F>(f)));
+	}
+
+	using node_type = node;
+
+	// queues node owned by the caller, it must stay alive until it's invoked, activating idle strand
+	// still posts one task to the underlying executor
+	void post_node(node_type & n) {
+		queue.push(&n);
+
+		if (pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+			schedule();
+		}
+	}
+
+	// waits until all posted tasks ran (the executor must be running them, so not from inside of
+	// a task of this strand or with executor polled by the calling thread)
+	void wait_idle() const noexcept {
+		while (pending.load(std::memory_order_acquire) != 0 || active.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	Executor & get_executor() const noexcept {
+		return underlying;
+	}
+};
+
+} // namespace hana23
+
+#endif
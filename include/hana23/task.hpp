@@ -0,0 +1,261 @@
+#ifndef HANA23_TASK_HPP
+#define HANA23_TASK_HPP
+
+#include "executor.hpp"
+#include "move_only_function.hpp"
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+
+namespace hana23 {
+
+// resumes a coroutine, it's just a pointer so it always fits into move_only_function's buffer
+struct _resume_coroutine {
+	std::coroutine_handle<> handle;
+
+	void operator()() && {
+		handle.resume();
+	}
+};
+
+static_assert(_move_only_function_sbo_compatible<_resume_coroutine>, "resuming coroutine through move_only_function must not allocate");
+
+// lazily started coroutine, when awaited from another coroutine it's started and on finish it resumes
+// the awaiting one directly through symmetric transfer, otherwise it's started with `start` and its
+// continuation is an arbitrary move_only_function<void() &&>
+
+template <typename T = void> class task;
+
+struct _task_promise_base {
+	std::coroutine_handle<> awaiting{};
+	move_only_function<void() &&> continuation{};
+	std::exception_ptr exception{};
+
+	struct final_awaiter {
+		bool await_ready() const noexcept {
+			return false;
+		}
+
+		template <typename Promise> std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+			_task_promise_base & promise = self.promise();
+
+			if (promise.awaiting) {
+				return promise.awaiting;
+			}
+
+			if (promise.continuation) {
+				// continuation can destroy the task (and the promise with it)
+				auto continuation = std::move(promise.continuation);
+				std::move(continuation)();
+			}
+
+			return std::noop_coroutine();
+		}
+
+		void await_resume() const noexcept { }
+	};
+
+	std::suspend_always initial_suspend() const noexcept {
+		return {};
+	}
+
+	final_awaiter final_suspend() const noexcept {
+		return {};
+	}
+
+	void unhandled_exception() noexcept {
+		exception = std::current_exception();
+	}
+
+	void rethrow_if_failed() const {
+		if (exception) {
+			std::rethrow_exception(exception);
+		}
+	}
+};
+
+template <typename T> struct _task_promise: _task_promise_base {
+	std::optional<T> value{};
+
+	task<T> get_return_object() noexcept;
+
+	template <typename U> void return_value(U && v) requires std::is_constructible_v<T, U> {
+		value.emplace(std::forward<U>(v));
+	}
+
+	T take_result() {
+		rethrow_if_failed();
+		assert(value.has_value());
+		return std::move(*value);
+	}
+};
+
+template <> struct _task_promise<void>: _task_promise_base {
+	task<void> get_return_object() noexcept;
+
+	void return_void() const noexcept { }
+
+	void take_result() const {
+		rethrow_if_failed();
+	}
+};
+
+template <typename T> class task {
+public:
+	using promise_type = _task_promise<T>;
+	using handle_type = std::coroutine_handle<promise_type>;
+
+private:
+	handle_type handle{};
+
+	struct awaiter {
+		handle_type handle;
+
+		// awaiting an empty task is a bug (there is no result to return)
+		bool await_ready() const noexcept {
+			assert(handle);
+			return handle.done();
+		}
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			handle.promise().awaiting = awaiting;
+			return handle;
+		}
+
+		T await_resume() {
+			return handle.promise().take_result();
+		}
+	};
+
+public:
+	task() noexcept = default;
+	explicit task(handle_type h) noexcept: handle{h} { }
+
+	task(task && other) noexcept: handle{std::exchange(other.handle, nullptr)} { }
+
+	task & operator=(task && other) noexcept {
+		if (this != &other) {
+			if (handle) {
+				handle.destroy();
+			}
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+
+	task(const task &) = delete;
+	task & operator=(const task &) = delete;
+
+	~task() {
+		if (handle) {
+			handle.destroy();
+		}
+	}
+
+	explicit operator bool() const noexcept {
+		return static_cast<bool>(handle);
+	}
+
+	bool done() const noexcept {
+		return handle && handle.done();
+	}
+
+	awaiter operator co_await() && noexcept {
+		return awaiter{handle};
+	}
+
+	// starts the coroutine, continuation is invoked when it finishes (the task must be alive until then)
+	void start(move_only_function<void() &&> continuation) {
+		assert(handle && !handle.done());
+		handle.promise().continuation = std::move(continuation);
+		handle.resume();
+	}
+
+	// result of finished task (rethrows its exception)
+	T get() {
+		assert(done());
+		return handle.promise().take_result();
+	}
+};
+
+template <typename T> task<T> _task_promise<T>::get_return_object() noexcept {
+	return task<T>{std::coroutine_handle<_task_promise<T>>::from_promise(*this)};
+}
+
+inline task<void> _task_promise<void>::get_return_object() noexcept {
+	return task<void>{std::coroutine_handle<_task_promise<void>>::from_promise(*this)};
+}
+
+// `co_await schedule_on(ex)` continues the coroutine on the executor, the coroutine is never resumed
+// if the executor drops the task without running it
+
+// executors accepting external nodes (thread_pool, priority_executor, strand) get the node embedded
+// in the awaiter, which lives in the suspended coroutine's frame, so the hop doesn't allocate
+template <executor Executor> auto schedule_on(Executor & ex) noexcept {
+	if constexpr (_intrusive_executor<Executor>) {
+		struct awaiter {
+			Executor & ex;
+			_external_task_node<typename Executor::node_type> node{};
+
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> self) {
+				node.function = [](void * address) { std::coroutine_handle<>::from_address(address).resume(); };
+				node.context = self.address();
+				ex.post_node(node);
+			}
+
+			void await_resume() const noexcept { }
+		};
+
+		return awaiter{ex};
+	} else {
+		struct awaiter {
+			Executor & ex;
+
+			bool await_ready() const noexcept {
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> self) {
+				ex.post(move_only_function<void() &&>{_resume_coroutine{self}});
+			}
+
+			void await_resume() const noexcept { }
+		};
+
+		return awaiter{ex};
+	}
+}
+
+// starts the task and blocks current thread until it finishes
+template <typename T> T sync_wait(task<T> t) {
+	struct state_t {
+		std::mutex mutex;
+		std::condition_variable finished;
+		bool done{false};
+	} state;
+
+	t.start([s = &state] {
+		// notify under lock, so the waiter can't destroy the state in the meantime
+		std::lock_guard lock{s->mutex};
+		s->done = true;
+		s->finished.notify_one();
+	});
+
+	std::unique_lock lock{state.mutex};
+	state.finished.wait(lock, [&] { return state.done; });
+
+	return t.get();
+}
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef HANA23_TASK_GROUP_HPP
+#define HANA23_TASK_GROUP_HPP
+
+#include "thread_pool.hpp"
+#include "utility/task_node.hpp"
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <cstddef>
+
+namespace hana23 {
+
+// fork-join scope over thread_pool: `run` spawns a task, `wait` returns once all of them finished
+// (and rethrows the first exception thrown by them)
+
+// group pointer is stored next to the callable inside the pool's task node, so spawning a task is
+// a single pooled allocation, `wait` executes pool's tasks while any are available
+
+class task_group {
+	template <typename Callable> struct group_task {
+		task_group * group;
+		[[no_unique_address]] Callable callable;
+
+		void operator()() && noexcept {
+			task_group * g = group;
+
+			try {
+				std::invoke(std::move(callable));
+			} catch (...) {
+				g->store_exception(std::current_exception());
+			}
+
+			// after this the group can be gone
+			g->outstanding.fetch_sub(1, std::memory_order_acq_rel);
+		}
+	};
+
+	thread_pool & pool;
+	std::atomic<size_t> outstanding{0};
+	std::atomic<bool> failed{false};
+	std::exception_ptr exception{};
+
+	void store_exception(std::exception_ptr ex) noexcept {
+		if (!failed.exchange(true, std::memory_order_acq_rel)) {
+			exception = std::move(ex);
+		}
+	}
+
+	void help_until_done() noexcept {
+		while (outstanding.load(std::memory_order_acquire) != 0) {
+			if (!pool.try_run_one()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+public:
+	explicit task_group(thread_pool & p) noexcept: pool{p} { }
+
+	task_group(const task_group &) = delete;
+	task_group & operator=(const task_group &) = delete;
+
+	~task_group() {
+		help_until_done();
+	}
+
+	template <typename F> void run(F && f) requires _is_task_for<F> {
+		outstanding.fetch_add(1, std::memory_order_relaxed);
+
+		try {
+			pool.post(group_task<std::decay_t<F>>{this, std::forward<F>(f)});
+		} catch (...) {
+			outstanding.fetch_sub(1, std::memory_order_relaxed);
+			throw;
+		}
+	}
+
+	void wait() {
+		help_until_done();
+
+		if (failed.load(std::memory_order_acquire)) {
+			failed.store(false, std::memory_order_relaxed);
+			std::rethrow_exception(std::exchange(exception, nullptr));
+		}
+	}
+};
+
+} // namespace hana23
+
+#endif
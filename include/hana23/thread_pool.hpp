@@ -0,0 +1,234 @@
+#ifndef HANA23_THREAD_POOL_HPP
+#define HANA23_THREAD_POOL_HPP
+
+#include "utility/task_node.hpp"
+#include "utility/work_stealing_deque.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// work-stealing pool: tasks posted from a worker go to its own deque (LIFO for the owner, FIFO for
+// thieves), tasks posted from elsewhere go to a shared injection queue
+
+// destruction waits until workers run out of tasks (including tasks posted by the tasks)
+
+// posted tasks must not throw: there is nobody to report the exception to, so one escaping a task
+// run by a worker calls std::terminate (one run by `try_run_one` propagates to its caller), tasks
+// which can fail should be run through task_group or report through a promise
+
+class thread_pool {
+	struct node: _task_node<> {
+		using task_base = _task_node<>;
+		using task_base::task_base;
+
+		node * next{nullptr};
+	};
+
+	struct worker {
+		_work_stealing_deque<node> deque{};
+		std::thread thread{};
+	};
+
+	// identity of the pool's worker running on this thread
+	static inline thread_local thread_pool * current_pool = nullptr;
+	static inline thread_local size_t current_worker = 0;
+
+	std::vector<std::unique_ptr<worker>> workers;
+
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	node * injected_head{nullptr};
+	node * injected_tail{nullptr};
+	std::atomic<size_t> injected_count{0};
+
+	std::atomic<uint64_t> epoch{0};
+	std::atomic<size_t> sleepers{0};
+	bool stopping{false};
+
+	size_t current_index() const noexcept {
+		return current_pool == this ? current_worker : workers.size();
+	}
+
+	void notify() {
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+
+		if (sleepers.load(std::memory_order_seq_cst) != 0) {
+			std::lock_guard lock{mutex};
+			wakeup.notify_one();
+		}
+	}
+
+	void push(node * n) {
+		if (const size_t index = current_index(); index != workers.size()) {
+			workers[index]->deque.push(n);
+		} else {
+			std::lock_guard lock{mutex};
+			if (injected_tail) {
+				injected_tail->next = n;
+			} else {
+				injected_head = n;
+			}
+			injected_tail = n;
+			injected_count.fetch_add(1, std::memory_order_release);
+		}
+
+		notify();
+	}
+
+	node * take_injected() noexcept {
+		if (injected_count.load(std::memory_order_acquire) == 0) {
+			return nullptr;
+		}
+
+		std::lock_guard lock{mutex};
+		node * result = injected_head;
+
+		if (result) {
+			injected_head = result->next;
+			if (!injected_head) {
+				injected_tail = nullptr;
+			}
+			result->next = nullptr;
+			injected_count.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		return result;
+	}
+
+	node * find_work(size_t self) noexcept {
+		if (self != workers.size()) {
+			if (node * n = workers[self]->deque.pop()) {
+				return n;
+			}
+		}
+
+		if (node * n = take_injected()) {
+			return n;
+		}
+
+		// steal starting from a neighbour so thieves don't all hit the same victim
+		const size_t count = workers.size();
+		for (size_t i = 1; i <= count; ++i) {
+			const size_t victim = (self + i) % count;
+			if (victim == self) {
+				continue;
+			}
+			if (node * n = workers[victim]->deque.steal()) {
+				return n;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// noexcept, so an exception escaping a task terminates right where it was thrown
+	void worker_loop(size_t self) noexcept {
+		current_pool = this;
+		current_worker = self;
+
+		for (;;) {
+			const uint64_t seen = epoch.load(std::memory_order_seq_cst);
+
+			if (node * n = find_work(self)) {
+				std::move(*n)();
+				continue;
+			}
+
+			std::unique_lock lock{mutex};
+			if (stopping) {
+				break;
+			}
+
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+			wakeup.wait(lock, [&] { return stopping || epoch.load(std::memory_order_seq_cst) != seen; });
+			sleepers.fetch_sub(1, std::memory_order_seq_cst);
+		}
+
+		current_pool = nullptr;
+	}
+
+public:
+	explicit thread_pool(size_t threads = std::thread::hardware_concurrency()) {
+		if (threads == 0) {
+			threads = 1;
+		}
+
+		workers.reserve(threads);
+		for (size_t i = 0; i != threads; ++i) {
+			workers.push_back(std::make_unique<worker>());
+		}
+
+		for (size_t i = 0; i != threads; ++i) {
+			workers[i]->thread = std::thread([this, i] { worker_loop(i); });
+		}
+	}
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool & operator=(const thread_pool &) = delete;
+
+	~thread_pool() {
+		{
+			std::lock_guard lock{mutex};
+			stopping = true;
+		}
+		wakeup.notify_all();
+
+		for (auto & w: workers) {
+			w->thread.join();
+		}
+
+		// workers are gone, so whoever pops from deques is the owner now
+		for (auto & w: workers) {
+			while (node * n = w->deque.pop()) {
+				n->destroy();
+			}
+		}
+
+		while (node * n = take_injected()) {
+			n->destroy();
+		}
+	}
+
+	template <typename F> void post(F && f) requires _is_task_for<F> {
+		push(_make_task_node<node>(std::forward<F>(f)));
+	}
+
+	using node_type = node;
+
+	// queues node owned by the caller, it must stay alive until it's invoked
+	void post_node(node_type & n) {
+		n.next = nullptr;
+		push(&n);
+	}
+
+	// runs one pending task on the calling thread, it's used to help while waiting for something
+	bool try_run_one() {
+		if (node * n = find_work(current_index())) {
+			std::move(*n)();
+			return true;
+		}
+
+		return false;
+	}
+
+	// true when called from one of this pool's workers
+	bool running_in_this_thread() const noexcept {
+		return current_pool == this;
+	}
+
+	size_t size() const noexcept {
+		return workers.size();
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef HANA23_TIMER_WHEEL_HPP
+#define HANA23_TIMER_WHEEL_HPP
+
+#include "move_only_function.hpp"
+#include <array>
+#include <bit>
+#include <utility>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// hierarchical hashed timer wheel (Varghese & Lauck) over abstract ticks, not thread-safe
+
+// entries live in a slab and keep the callback inline, a handle is slab index with generation which
+// makes stale handles harmless, insert and cancel are O(1) and cancelled entry's slot is recycled
+
+// each level has 64 slots and an occupancy bitmap, so advancing over empty time skips whole levels,
+// expired slot is detached as a batch and its callbacks are invoked afterwards (they can schedule
+// or cancel other timers), timers expiring at the same tick fire in unspecified order
+
+class timer_wheel {
+public:
+	using tick_t = uint64_t;
+
+	struct handle {
+		uint32_t index{invalid};
+		uint32_t generation{0};
+
+		static constexpr uint32_t invalid = static_cast<uint32_t>(-1);
+
+		explicit operator bool() const noexcept {
+			return index != invalid;
+		}
+
+		friend bool operator==(const handle &, const handle &) = default;
+	};
+
+private:
+	static constexpr unsigned slot_bits = 6;
+	static constexpr unsigned slots = 1u << slot_bits;
+	static constexpr unsigned levels = (64 + slot_bits - 1) / slot_bits;
+	static constexpr uint32_t none = static_cast<uint32_t>(-1);
+
+	// bucket of entries being fired in current batch
+	static constexpr uint32_t firing = levels * slots;
+	static constexpr uint32_t free_bucket = firing + 1;
+
+	struct entry {
+		move_only_function<void() &&> callback{};
+		tick_t expiry{0};
+		uint32_t generation{0};
+		uint32_t bucket{free_bucket};
+		uint32_t previous{none};
+		uint32_t next{none};
+	};
+
+	std::vector<entry> entries{};
+	std::array<uint32_t, levels * slots + 1> heads;
+	std::array<uint64_t, levels> occupied{};
+	uint32_t free_head{none};
+	size_t active_count{0};
+	tick_t current;
+
+	void link(uint32_t index, uint32_t bucket) noexcept {
+		entry & e = entries[index];
+		e.bucket = bucket;
+		e.previous = none;
+		e.next = heads[bucket];
+
+		if (e.next != none) {
+			entries[e.next].previous = index;
+		}
+
+		heads[bucket] = index;
+
+		if (bucket < firing) {
+			occupied[bucket / slots] |= uint64_t{1} << (bucket % slots);
+		}
+	}
+
+	void unlink(uint32_t index) noexcept {
+		entry & e = entries[index];
+
+		if (e.previous != none) {
+			entries[e.previous].next = e.next;
+		} else {
+			heads[e.bucket] = e.next;
+		}
+
+		if (e.next != none) {
+			entries[e.next].previous = e.previous;
+		}
+
+		if (e.bucket < firing && heads[e.bucket] == none) {
+			occupied[e.bucket / slots] &= ~(uint64_t{1} << (e.bucket % slots));
+		}
+	}
+
+	uint32_t bucket_for(tick_t expiry) const noexcept {
+		const tick_t difference = expiry ^ current;
+		const unsigned level = difference == 0 ? 0 : static_cast<unsigned>(63 - std::countl_zero(difference)) / slot_bits;
+		const unsigned slot = static_cast<unsigned>(expiry >> (level * slot_bits)) & (slots - 1);
+		return level * slots + slot;
+	}
+
+	void release(uint32_t index) noexcept {
+		entry & e = entries[index];
+		e.callback = nullptr;
+		e.bucket = free_bucket;
+		++e.generation;
+		e.next = free_head;
+		free_head = index;
+		--active_count;
+	}
+
+	// moves entries of the slot into lower levels, relative to new current time
+	void cascade(uint32_t bucket) noexcept {
+		uint32_t index = heads[bucket];
+		heads[bucket] = none;
+		occupied[bucket / slots] &= ~(uint64_t{1} << (bucket % slots));
+
+		while (index != none) {
+			const uint32_t next = entries[index].next;
+			link(index, bucket_for(entries[index].expiry));
+			index = next;
+		}
+	}
+
+	// if a callback throws, rest of the batch stays here and fires on the next advance
+	size_t fire_detached() {
+		size_t count = 0;
+
+		while (heads[firing] != none) {
+			const uint32_t index = heads[firing];
+			unlink(index);
+
+			auto callback = std::move(entries[index].callback);
+			release(index);
+
+			std::move(callback)();
+			++count;
+		}
+
+		return count;
+	}
+
+	size_t fire(uint32_t bucket) {
+		// whole slot is detached at once, callbacks can cancel other entries from the batch
+		uint32_t index = heads[bucket];
+		heads[bucket] = none;
+		occupied[0] &= ~(uint64_t{1} << bucket);
+
+		while (index != none) {
+			const uint32_t next = entries[index].next;
+			link(index, firing);
+			index = next;
+		}
+
+		return fire_detached();
+	}
+
+	size_t step(tick_t tick) {
+		current = tick;
+
+		for (unsigned level = levels - 1; level != 0; --level) {
+			const unsigned shift = level * slot_bits;
+			if ((tick & ((tick_t{1} << shift) - 1)) == 0) {
+				const uint32_t bucket = level * slots + (static_cast<unsigned>(tick >> shift) & (slots - 1));
+				if (heads[bucket] != none) {
+					cascade(bucket);
+				}
+			}
+		}
+
+		const uint32_t bucket = static_cast<uint32_t>(tick & (slots - 1));
+		return heads[bucket] != none ? fire(bucket) : 0;
+	}
+
+public:
+	explicit timer_wheel(tick_t start = 0) noexcept: current{start} {
+		heads.fill(none);
+	}
+
+	timer_wheel(const timer_wheel &) = delete;
+	timer_wheel & operator=(const timer_wheel &) = delete;
+
+	tick_t now() const noexcept {
+		return current;
+	}
+
+	size_t size() const noexcept {
+		return active_count;
+	}
+
+	bool empty() const noexcept {
+		return active_count == 0;
+	}
+
+	void reserve(size_t count) {
+		entries.reserve(count);
+	}
+
+	// first tick where advancing does something: expiry of the nearest timer if it's within current
+	// 64 ticks, otherwise cascade of the nearest slot (lower bound of the expiry)
+	tick_t next_event() const noexcept {
+		if (heads[firing] != none) {
+			return current;
+		}
+
+		// slots of the lowest occupied level are all ahead of current time in their rotation
+		for (unsigned level = 0; level != levels; ++level) {
+			if (occupied[level] == 0) {
+				continue;
+			}
+
+			const unsigned shift = level * slot_bits;
+			const unsigned above = shift + slot_bits;
+			const tick_t base = above >= 64 ? 0 : (current >> above) << above;
+			return base | (tick_t{static_cast<unsigned>(std::countr_zero(occupied[level]))} << shift);
+		}
+
+		return static_cast<tick_t>(-1);
+	}
+
+	// callback fires during `advance_to` reaching the expiry, but not sooner than on the next tick
+	handle schedule_at(tick_t expiry, move_only_function<void() &&> callback) {
+		assert(callback);
+
+		if (expiry <= current) {
+			expiry = current + 1;
+		}
+
+		uint32_t index = free_head;
+
+		if (index != none) {
+			free_head = entries[index].next;
+		} else {
+			assert(entries.size() < none);
+			index = static_cast<uint32_t>(entries.size());
+			entries.emplace_back();
+		}
+
+		entry & e = entries[index];
+		e.callback = std::move(callback);
+		e.expiry = expiry;
+		link(index, bucket_for(expiry));
+		++active_count;
+
+		return {index, e.generation};
+	}
+
+	handle schedule_after(tick_t delay, move_only_function<void() &&> callback) {
+		return schedule_at(current + delay, std::move(callback));
+	}
+
+	bool active(handle h) const noexcept {
+		return h.index < entries.size() && entries[h.index].generation == h.generation && entries[h.index].bucket != free_bucket;
+	}
+
+	// returns false for stale handle (already fired or cancelled)
+	bool cancel(handle h) noexcept {
+		if (!active(h)) {
+			return false;
+		}
+
+		unlink(h.index);
+		release(h.index);
+		return true;
+	}
+
+	// returns number of fired callbacks
+	size_t advance_to(tick_t target) {
+		size_t count = fire_detached();
+
+		while (current < target) {
+			if (active_count == 0) {
+				current = target;
+				break;
+			}
+
+			const tick_t next = next_event();
+			count += step(next < target ? next : target);
+		}
+
+		return count;
+	}
+
+	size_t advance(tick_t ticks) {
+		return advance_to(current + ticks);
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef HANA23_UTILITY_BOUNDED_QUEUE_HPP
+#define HANA23_UTILITY_BOUNDED_QUEUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+
+namespace hana23 {
+
+// bounded lock-free multi-producer multi-consumer ring (Dmitry Vyukov's design), values live inline in slots
+
+template <typename T> class _bounded_queue {
+	struct cell {
+		std::atomic<size_t> sequence;
+		std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+
+		T * get_pointer() noexcept {
+			return static_cast<T *>(static_cast<void *>(&storage));
+		}
+	};
+
+	static size_t round_up(size_t capacity) noexcept {
+		size_t result = 2;
+		while (result < capacity) result <<= 1;
+		return result;
+	}
+
+	const size_t mask;
+	std::unique_ptr<cell[]> cells;
+
+	// producers and consumers shouldn't share a cache line
+	alignas(64) std::atomic<size_t> enqueue_position{0};
+	alignas(64) std::atomic<size_t> dequeue_position{0};
+
+public:
+	// capacity is rounded up to power of two
+	explicit _bounded_queue(size_t capacity): mask{round_up(capacity) - 1}, cells{new cell[mask + 1]} {
+		for (size_t i = 0; i != mask + 1; ++i) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	_bounded_queue(const _bounded_queue &) = delete;
+	_bounded_queue & operator=(const _bounded_queue &) = delete;
+
+	~_bounded_queue() {
+		T tmp;
+		while (try_pop(tmp)) { }
+	}
+
+	size_t capacity() const noexcept {
+		return mask + 1;
+	}
+
+	// returns false if full, value is untouched in such case
+	template <typename U> bool try_push(U && value) noexcept(std::is_nothrow_constructible_v<T, U>) {
+		size_t position = enqueue_position.load(std::memory_order_relaxed);
+		cell * c;
+
+		for (;;) {
+			c = &cells[position & mask];
+			const size_t sequence = c->sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+			if (difference == 0) {
+				if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = enqueue_position.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (c->get_pointer()) T(std::forward<U>(value));
+		c->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// returns false if empty (or if the oldest push is still in progress)
+	bool try_pop(T & output) noexcept(std::is_nothrow_move_assignable_v<T>) {
+		size_t position = dequeue_position.load(std::memory_order_relaxed);
+		cell * c;
+
+		for (;;) {
+			c = &cells[position & mask];
+			const size_t sequence = c->sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+
+			if (difference == 0) {
+				if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				return false;
+			} else {
+				position = dequeue_position.load(std::memory_order_relaxed);
+			}
+		}
+
+		output = std::move(*c->get_pointer());
+		c->get_pointer()->~T();
+		c->sequence.store(position + mask + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+} // namespace hana23
+
+#endif
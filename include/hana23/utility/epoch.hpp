@@ -0,0 +1,179 @@
+#ifndef HANA23_UTILITY_EPOCH_HPP
+#define HANA23_UTILITY_EPOCH_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// epoch-based reclamation (Fraser) shared by the whole program: readers announce the global epoch
+// while they hold a guard, an object retired during epoch E is freed once the global epoch reaches
+// E + 2, which can happen only after every reader active at the time of retiring has left
+
+// readers never block or write shared memory except their own record, retiring takes a lock, but
+// deleters run after it's released, so a destructor can retire through the domain too
+
+class _epoch_domain {
+	struct record {
+		// 0 when the thread is outside of any guard
+		std::atomic<uint64_t> epoch{0};
+		std::atomic<bool> in_use{true};
+		uint32_t nesting{0};
+		record * next{nullptr};
+	};
+
+	struct retired_t {
+		uint64_t epoch;
+		void * ptr;
+		void (*deleter)(void *) noexcept;
+	};
+
+	// releases thread's record for reuse when the thread exits
+	struct thread_record {
+		record * r{nullptr};
+
+		~thread_record() {
+			if (r) {
+				r->in_use.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	std::atomic<uint64_t> global{1};
+	std::atomic<record *> records{nullptr};
+
+	std::mutex mutex{};
+	std::vector<retired_t> retired{};
+
+	record * acquire_record() {
+		for (record * r = records.load(std::memory_order_acquire); r; r = r->next) {
+			bool expected = false;
+			if (!r->in_use.load(std::memory_order_relaxed) && r->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+				return r;
+			}
+		}
+
+		// records are never unlinked, so pushing is ABA-free
+		record * r = new record{};
+		record * head = records.load(std::memory_order_relaxed);
+		do {
+			r->next = head;
+		} while (!records.compare_exchange_weak(head, r, std::memory_order_release, std::memory_order_relaxed));
+
+		return r;
+	}
+
+	static record & local() {
+		static thread_local thread_record instance;
+		if (!instance.r) {
+			instance.r = domain().acquire_record();
+		}
+		return *instance.r;
+	}
+
+	// under the lock
+	bool try_advance() noexcept {
+		uint64_t current = global.load(std::memory_order_seq_cst);
+
+		for (record * r = records.load(std::memory_order_acquire); r; r = r->next) {
+			const uint64_t announced = r->epoch.load(std::memory_order_seq_cst);
+			if (announced != 0 && announced != current) {
+				return false;
+			}
+		}
+
+		return global.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+	}
+
+	// under the lock, removes items which can be deleted and returns them
+	std::vector<retired_t> take_reclaimable() {
+		const uint64_t current = global.load(std::memory_order_seq_cst);
+
+		// reclaimable items are moved to the end, kept ones keep their order
+		const auto first = std::stable_partition(retired.begin(), retired.end(), [current](const retired_t & item) { return item.epoch + 2 > current; });
+
+		std::vector<retired_t> result{first, retired.end()};
+		retired.erase(first, retired.end());
+		return result;
+	}
+
+public:
+	static _epoch_domain & domain() {
+		static _epoch_domain instance;
+		return instance;
+	}
+
+	_epoch_domain() = default;
+	_epoch_domain(const _epoch_domain &) = delete;
+	_epoch_domain & operator=(const _epoch_domain &) = delete;
+
+	// no thread can be inside of a guard anymore
+	~_epoch_domain() {
+		// deleters can retire more objects
+		while (!retired.empty()) {
+			for (retired_t & item: std::exchange(retired, {})) {
+				item.deleter(item.ptr);
+			}
+		}
+
+		record * r = records.load(std::memory_order_relaxed);
+		while (r) {
+			record * next = r->next;
+			delete r;
+			r = next;
+		}
+	}
+
+	// objects retired before the guard was created stay alive until it's destroyed, guards can nest
+	class guard {
+		record & r;
+
+	public:
+		guard(): r{local()} {
+			if (r.nesting++ == 0) {
+				// must be visible before any shared pointer is read
+				r.epoch.store(domain().global.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+			}
+		}
+
+		guard(const guard &) = delete;
+		guard & operator=(const guard &) = delete;
+
+		~guard() {
+			if (--r.nesting == 0) {
+				r.epoch.store(0, std::memory_order_release);
+			}
+		}
+	};
+
+	// object must be already unreachable for new readers
+	template <typename T> void retire(T * ptr) {
+		std::vector<retired_t> reclaimable;
+
+		{
+			std::lock_guard lock{mutex};
+
+			retired.push_back({global.load(std::memory_order_seq_cst), ptr, [](void * p) noexcept { delete static_cast<T *>(p); }});
+
+			// without readers two advances make everything retired so far reclaimable
+			if (try_advance()) {
+				try_advance();
+			}
+
+			reclaimable = take_reclaimable();
+		}
+
+		for (retired_t & item: reclaimable) {
+			item.deleter(item.ptr);
+		}
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef HANA23_UTILITY_EVENT_HANDLER_HPP
+#define HANA23_UTILITY_EVENT_HANDLER_HPP
+
+#include "move_only_function.hpp"
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+namespace hana23 {
+
+// persistent `void(int events)` handler of event_loop: same vtable layout as move_only_function, but
+// with inline storage of four pointers (move_only_function's buffer is one pointer unless it's
+// configured for the whole program), so a handler capturing e.g. `this`, fd and a buffer pointer
+// doesn't allocate, bigger callables are boxed on heap
+
+class _event_handler {
+public:
+	static constexpr size_t buffer_size = 4 * sizeof(void *);
+
+	template <typename T> static constexpr bool is_inline = (sizeof(T) <= buffer_size) && (alignof(T) <= alignof(void *)) && std::is_nothrow_move_constructible_v<T>;
+
+private:
+	struct storage_t {
+		alignas(void *) unsigned char data[buffer_size];
+	};
+
+	struct vtable_t {
+		virtual void call(storage_t & obj, int events) const = 0;
+		// moves the callable and destroys the source
+		virtual void relocate(storage_t & destination, storage_t & source) const noexcept = 0;
+		virtual void destroy(storage_t & obj) const noexcept = 0;
+	};
+
+	template <typename Callable> struct inline_implementation final: vtable_t {
+		static Callable & get(storage_t & obj) noexcept {
+			return *std::launder(reinterpret_cast<Callable *>(&obj));
+		}
+
+		void call(storage_t & obj, int events) const final {
+			std::invoke(get(obj), events);
+		}
+
+		void relocate(storage_t & destination, storage_t & source) const noexcept final {
+			new (&destination) Callable(std::move(get(source)));
+			get(source).~Callable();
+		}
+
+		void destroy(storage_t & obj) const noexcept final {
+			get(obj).~Callable();
+		}
+	};
+
+	template <typename Callable> struct boxed_implementation final: vtable_t {
+		static Callable *& get(storage_t & obj) noexcept {
+			return *std::launder(reinterpret_cast<Callable **>(&obj));
+		}
+
+		void call(storage_t & obj, int events) const final {
+			std::invoke(*get(obj), events);
+		}
+
+		void relocate(storage_t & destination, storage_t & source) const noexcept final {
+			new (&destination) Callable *(get(source));
+		}
+
+		void destroy(storage_t & obj) const noexcept final {
+			_destroy_heap_callable(get(obj));
+		}
+	};
+
+	template <typename Callable> static constexpr auto vtable_for = std::conditional_t<is_inline<Callable>, inline_implementation<Callable>, boxed_implementation<Callable>>{};
+
+	const vtable_t * vtable{nullptr};
+	storage_t storage{};
+
+	void release() noexcept {
+		if (vtable) {
+			vtable->destroy(storage);
+			vtable = nullptr;
+		}
+	}
+
+public:
+	_event_handler() noexcept = default;
+	_event_handler(std::nullptr_t) noexcept { }
+
+	template <typename F> _event_handler(F && f) requires(!std::is_same_v<std::remove_cvref_t<F>, _event_handler> && std::is_invocable_v<std::decay_t<F> &, int>) {
+		using callable_t = std::decay_t<F>;
+
+		// empty function pointers and functions stay empty
+		if constexpr (_is_comparable_with_nullptr<callable_t>) {
+			if (f == nullptr) {
+				return;
+			}
+		}
+
+		if constexpr (is_inline<callable_t>) {
+			new (&storage) callable_t(std::forward<F>(f));
+		} else {
+			new (&storage) callable_t *(new callable_t(std::forward<F>(f)));
+		}
+		vtable = &vtable_for<callable_t>;
+	}
+
+	_event_handler(_event_handler && other) noexcept: vtable{std::exchange(other.vtable, nullptr)} {
+		if (vtable) {
+			vtable->relocate(storage, other.storage);
+		}
+	}
+
+	_event_handler & operator=(_event_handler && other) noexcept {
+		if (this != &other) {
+			release();
+			if (other.vtable) {
+				other.vtable->relocate(storage, other.storage);
+				vtable = std::exchange(other.vtable, nullptr);
+			}
+		}
+		return *this;
+	}
+
+	_event_handler & operator=(std::nullptr_t) noexcept {
+		release();
+		return *this;
+	}
+
+	~_event_handler() {
+		release();
+	}
+
+	explicit operator bool() const noexcept {
+		return vtable != nullptr;
+	}
+
+	void operator()(int events) {
+		vtable->call(storage, events);
+	}
+};
+
+} // namespace hana23
+
+#endif
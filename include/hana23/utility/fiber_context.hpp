@@ -0,0 +1,115 @@
+#ifndef HANA23_UTILITY_FIBER_CONTEXT_HPP
+#define HANA23_UTILITY_FIBER_CONTEXT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(__linux__) || !defined(__x86_64__)
+#error "hana23 fibers are implemented only for x86-64 linux"
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define HANA23_FIBER_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define HANA23_FIBER_ASAN 1
+#endif
+#endif
+
+#ifdef HANA23_FIBER_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+// saves callee-saved registers (and SSE/x87 control words) on current stack, stores stack pointer
+// into *save_sp and continues with the context saved on new_sp
+extern "C" void _hana23_fiber_switch(void ** save_sp, void * new_sp) noexcept;
+
+// first "return address" of a new context, calls r13(r12) which must never return
+extern "C" void _hana23_fiber_trampoline() noexcept;
+
+// the code lives in a COMDAT group so the header can be included from multiple translation units
+asm(R"(
+	.pushsection .text._hana23_fiber_switch,"axG",@progbits,_hana23_fiber_switch,comdat
+	.globl _hana23_fiber_switch
+	.hidden _hana23_fiber_switch
+	.type _hana23_fiber_switch,@function
+	.p2align 4
+_hana23_fiber_switch:
+	pushq %rbp
+	pushq %rbx
+	pushq %r12
+	pushq %r13
+	pushq %r14
+	pushq %r15
+	subq $8, %rsp
+	stmxcsr (%rsp)
+	fnstcw 4(%rsp)
+	movq %rsp, (%rdi)
+	movq %rsi, %rsp
+	ldmxcsr (%rsp)
+	fldcw 4(%rsp)
+	addq $8, %rsp
+	popq %r15
+	popq %r14
+	popq %r13
+	popq %r12
+	popq %rbx
+	popq %rbp
+	ret
+	.size _hana23_fiber_switch,.-_hana23_fiber_switch
+
+	.globl _hana23_fiber_trampoline
+	.hidden _hana23_fiber_trampoline
+	.type _hana23_fiber_trampoline,@function
+	.p2align 4
+_hana23_fiber_trampoline:
+	movq %r12, %rdi
+	callq *%r13
+	ud2
+	.size _hana23_fiber_trampoline,.-_hana23_fiber_trampoline
+	.popsection
+)");
+
+namespace hana23 {
+
+// prepares stack so the first switch to it calls entry(argument), top must be 16 bytes aligned
+inline void * _make_fiber_context(void * top, void (*entry)(void *), void * argument) noexcept {
+	auto * sp = static_cast<uint64_t *>(top) - 8;
+
+	// mxcsr and x87 control word (default values), then registers in order of popping
+	const uint32_t mxcsr = 0x1F80;
+	const uint16_t fpcw = 0x037F;
+	sp[0] = 0;
+	std::memcpy(&sp[0], &mxcsr, sizeof(mxcsr));
+	std::memcpy(reinterpret_cast<char *>(&sp[0]) + 4, &fpcw, sizeof(fpcw));
+	sp[1] = 0; // r15
+	sp[2] = 0; // r14
+	sp[3] = reinterpret_cast<uint64_t>(entry); // r13
+	sp[4] = reinterpret_cast<uint64_t>(argument); // r12
+	sp[5] = 0; // rbx
+	sp[6] = 0; // rbp
+	sp[7] = reinterpret_cast<uint64_t>(&_hana23_fiber_trampoline);
+
+	return sp;
+}
+
+// AddressSanitizer needs to know about stack switches
+struct _fiber_sanitizer {
+#ifdef HANA23_FIBER_ASAN
+	static void start_switch(void ** fake_stack, const void * bottom, size_t size) noexcept {
+		__sanitizer_start_switch_fiber(fake_stack, bottom, size);
+	}
+
+	static void finish_switch(void * fake_stack, const void ** old_bottom, size_t * old_size) noexcept {
+		__sanitizer_finish_switch_fiber(fake_stack, old_bottom, old_size);
+	}
+#else
+	static void start_switch(void **, const void *, size_t) noexcept { }
+	static void finish_switch(void *, const void **, size_t *) noexcept { }
+#endif
+};
+
+} // namespace hana23
+
+#endif
@@ -11,11 +11,42 @@ using std::size_t;
 
 // is in_place
 
-constexpr inline size_t _move_only_function_buffer_size = sizeof(void *);
+// size of inline buffer can be changed for whole program (it must be same in all translation units)
+#ifndef HANA23_MOVE_ONLY_FUNCTION_BUFFER_SIZE
+#define HANA23_MOVE_ONLY_FUNCTION_BUFFER_SIZE sizeof(void *)
+#endif
 
-template <typename T> static constexpr bool _move_only_function_sbo_compatible = (sizeof(T) <= _move_only_function_buffer_size) && std::is_nothrow_move_constructible_v<T>;
+constexpr inline size_t _move_only_function_buffer_size = HANA23_MOVE_ONLY_FUNCTION_BUFFER_SIZE;
 
-using _move_only_function_storage_t = std::aligned_storage_t<_move_only_function_buffer_size>;
+static_assert(_move_only_function_buffer_size >= sizeof(void *), "buffer must be able to hold at least pointer to heap allocated callable");
+
+// pointer aligned, so with the default buffer the whole function is two words (more strictly aligned callables are allocated)
+struct _move_only_function_storage_t {
+	alignas(void *) unsigned char data[_move_only_function_buffer_size];
+};
+
+template <typename T> static constexpr bool _move_only_function_sbo_compatible = (sizeof(T) <= _move_only_function_buffer_size) && (alignof(T) <= alignof(_move_only_function_storage_t)) && std::is_nothrow_move_constructible_v<T>;
+
+// receiver of heap allocated callables which shouldn't be destroyed on current thread (see deferred_deleter.hpp)
+struct _deferred_destruction {
+	// returns false if the object wasn't accepted and needs to be destroyed by the caller
+	virtual bool defer(void * object, void (*destroy)(void *) noexcept) noexcept = 0;
+
+protected:
+	~_deferred_destruction() = default;
+};
+
+inline thread_local _deferred_destruction * _deferred_destruction_target = nullptr;
+
+template <typename Callable> void _destroy_heap_callable(Callable * ptr) noexcept {
+	if (_deferred_destruction * target = _deferred_destruction_target; target && ptr) {
+		if (target->defer(ptr, [](void * object) noexcept { delete static_cast<Callable *>(object); })) {
+			return;
+		}
+	}
+
+	delete ptr;
+}
 
 template <typename> struct _is_in_place_type_t: std::false_type { };
 template <typename T> struct _is_in_place_type_t<std::in_place_type_t<T>>: std::true_type { };
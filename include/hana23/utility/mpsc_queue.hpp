@@ -0,0 +1,89 @@
+#ifndef HANA23_UTILITY_MPSC_QUEUE_HPP
+#define HANA23_UTILITY_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <thread>
+
+namespace hana23 {
+
+// intrusive multi-producer single-consumer queue (Dmitry Vyukov's design), nodes derive from the hook
+
+struct _mpsc_hook {
+	std::atomic<_mpsc_hook *> next{nullptr};
+};
+
+template <typename Node> class _mpsc_queue {
+	std::atomic<_mpsc_hook *> head{&stub};
+	_mpsc_hook * tail{&stub};
+	_mpsc_hook stub{};
+
+	void push_hook(_mpsc_hook * hook) noexcept {
+		hook->next.store(nullptr, std::memory_order_relaxed);
+		_mpsc_hook * previous = head.exchange(hook, std::memory_order_acq_rel);
+		// between these two lines the queue is temporarily disconnected for consumer
+		previous->next.store(hook, std::memory_order_release);
+	}
+
+public:
+	_mpsc_queue() noexcept = default;
+	_mpsc_queue(const _mpsc_queue &) = delete;
+	_mpsc_queue & operator=(const _mpsc_queue &) = delete;
+
+	void push(Node * node) noexcept {
+		push_hook(node);
+	}
+
+	// consumer only, returns nullptr if empty or if a producer is in the middle of push
+	Node * try_pop() noexcept {
+		_mpsc_hook * current = tail;
+		_mpsc_hook * next = current->next.load(std::memory_order_acquire);
+
+		if (current == &stub) {
+			if (next == nullptr) {
+				return nullptr;
+			}
+			tail = next;
+			current = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+
+		if (next) {
+			tail = next;
+			return static_cast<Node *>(current);
+		}
+
+		if (current != head.load(std::memory_order_acquire)) {
+			return nullptr;
+		}
+
+		push_hook(&stub);
+
+		next = current->next.load(std::memory_order_acquire);
+
+		if (next) {
+			tail = next;
+			return static_cast<Node *>(current);
+		}
+
+		return nullptr;
+	}
+
+	// consumer only, use only when it's known there is a node (eg. from external counter)
+	Node * pop() noexcept {
+		for (;;) {
+			if (Node * result = try_pop()) {
+				return result;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	// consumer only
+	bool empty() const noexcept {
+		return tail == &stub && tail->next.load(std::memory_order_acquire) == nullptr;
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef HANA23_UTILITY_NODE_POOL_HPP
+#define HANA23_UTILITY_NODE_POOL_HPP
+
+#include <new>
+#include <cstddef>
+
+namespace hana23 {
+
+// per-thread cache of small blocks in few size classes, it's used for short-lived nodes which are
+// usually allocated and released at high rate (blocks released on another thread migrate to its cache)
+
+struct _node_pool {
+	static constexpr size_t granularity = 64;
+	static constexpr size_t classes = 4;
+	static constexpr size_t max_size = granularity * classes;
+	static constexpr size_t max_cached = 256;
+
+	static constexpr bool is_pooled(size_t size) noexcept {
+		return size <= max_size;
+	}
+
+private:
+	struct free_block {
+		free_block * next;
+	};
+
+	struct cache {
+		free_block * heads[classes]{};
+		size_t counts[classes]{};
+
+		~cache() {
+			for (free_block * head: heads) {
+				while (head) {
+					free_block * next = head->next;
+					::operator delete(head);
+					head = next;
+				}
+			}
+			destroyed = true;
+		}
+	};
+
+	// cache can be accessed from other thread_local destructors after it was destroyed
+	static inline thread_local bool destroyed = false;
+
+	static cache * local() noexcept {
+		if (destroyed) {
+			return nullptr;
+		}
+		static thread_local cache instance;
+		return &instance;
+	}
+
+	static constexpr size_t class_of(size_t size) noexcept {
+		return (size - 1) / granularity;
+	}
+
+public:
+	static void * allocate(size_t size) {
+		if (!is_pooled(size)) {
+			return ::operator new(size);
+		}
+
+		const size_t index = class_of(size);
+
+		if (cache * c = local(); c && c->heads[index]) {
+			free_block * block = c->heads[index];
+			c->heads[index] = block->next;
+			--c->counts[index];
+			return block;
+		}
+
+		return ::operator new((index + 1) * granularity);
+	}
+
+	static void deallocate(void * ptr, size_t size) noexcept {
+		if (!is_pooled(size)) {
+			::operator delete(ptr);
+			return;
+		}
+
+		const size_t index = class_of(size);
+
+		if (cache * c = local(); c && c->counts[index] < max_cached) {
+			c->heads[index] = new (ptr) free_block{c->heads[index]};
+			++c->counts[index];
+			return;
+		}
+
+		::operator delete(ptr);
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef HANA23_UTILITY_TASK_NODE_HPP
+#define HANA23_UTILITY_TASK_NODE_HPP
+
+#include "move_only_function.hpp"
+#include "node_pool.hpp"
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace hana23 {
+
+// intrusive one-shot task: links of the owning queue live in the derived node type (Node)
+// and the callable is stored right after them, so a queued task is exactly one allocation
+
+template <typename... Args> struct _task_node {
+	struct vtable_t {
+		// invokes callable as rvalue and destroys the node afterwards (even if it throws)
+		virtual void call(_task_node & node, Args... args) const = 0;
+		// destroys the node without invoking
+		virtual void destroy(_task_node & node) const noexcept = 0;
+	};
+
+	const vtable_t * vtable;
+
+	explicit constexpr _task_node(const vtable_t * vt) noexcept: vtable{vt} { }
+
+	_task_node(const _task_node &) = delete;
+	_task_node & operator=(const _task_node &) = delete;
+
+	void operator()(Args... args) && {
+		vtable->call(*this, std::forward<Args>(args)...);
+	}
+
+	void destroy() noexcept {
+		vtable->destroy(*this);
+	}
+
+protected:
+	~_task_node() = default;
+};
+
+template <typename Node, typename Callable> struct _task_node_impl final: Node {
+	[[no_unique_address]] Callable callable;
+
+	template <typename Base> struct implementation;
+
+	template <typename... Args> struct implementation<_task_node<Args...>>: _task_node<Args...>::vtable_t {
+		void call(_task_node<Args...> & node, Args... args) const final {
+			std::unique_ptr<_task_node_impl> self{static_cast<_task_node_impl *>(&node)};
+			std::invoke(std::move(self->callable), std::forward<Args>(args)...);
+		}
+
+		void destroy(_task_node<Args...> & node) const noexcept final {
+			delete static_cast<_task_node_impl *>(&node);
+		}
+	};
+
+	static constexpr auto vtable_instance = implementation<typename Node::task_base>{};
+
+	template <typename... CArgs> explicit _task_node_impl(CArgs &&... args): Node{&vtable_instance}, callable(std::forward<CArgs>(args)...) { }
+
+	// nodes are short-lived, small ones are recycled through per-thread pool
+	static void * operator new(size_t size) {
+		return _node_pool::allocate(size);
+	}
+
+	static void operator delete(void * ptr, size_t size) noexcept {
+		_node_pool::deallocate(ptr, size);
+	}
+
+	static void * operator new(size_t size, std::align_val_t alignment) {
+		return ::operator new(size, alignment);
+	}
+
+	static void operator delete(void * ptr, size_t size, std::align_val_t alignment) noexcept {
+		::operator delete(ptr, size, alignment);
+	}
+};
+
+// node whose storage belongs to the poster (e.g. it's embedded in an awaiter), invocation and destroy
+// don't free it and invocation doesn't touch it after calling the function, so the function can
+// release the storage and the node can be posted again once it was invoked
+template <typename Node> struct _external_task_node final: Node {
+	using task_base = typename Node::task_base;
+
+	void (*function)(void * context){nullptr};
+	void * context{nullptr};
+
+	struct implementation: task_base::vtable_t {
+		void call(task_base & node) const final {
+			auto & self = static_cast<_external_task_node &>(node);
+			self.function(self.context);
+		}
+
+		void destroy(task_base &) const noexcept final { }
+	};
+
+	static constexpr implementation vtable_instance{};
+
+	_external_task_node() noexcept: Node{&vtable_instance} { }
+};
+
+// executor which can queue a node provided by the poster (without allocating its own one)
+template <typename E> concept _intrusive_executor = requires(E & ex, _external_task_node<typename E::node_type> & n) {
+	ex.post_node(n);
+};
+
+// Node must expose `using task_base = _task_node<Args...>` and inherit its constructor
+template <typename Node, typename F> Node * _make_task_node(F && f) {
+	return new _task_node_impl<Node, std::decay_t<F>>(std::forward<F>(f));
+}
+
+// same requirement as move_only_function<void(Args...) &&> puts on its callable
+template <typename F, typename... Args> concept _is_task_for = std::is_constructible_v<std::decay_t<F>, F> && _is_invocable<void(Args...) &&>::template from_v<std::decay_t<F>>;
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef HANA23_UTILITY_VECTOR_GROWTH_HPP
+#define HANA23_UTILITY_VECTOR_GROWTH_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace hana23 {
+
+// makes room for one more element with geometric growth (reserve(size() + 1) allocates exactly that
+// much and makes a sequence of pushes quadratic), used where all allocations have to happen before
+// any modification
+
+template <typename T, typename Allocator> void _reserve_one_more(std::vector<T, Allocator> & v) {
+	if (v.size() == v.capacity()) {
+		const size_t doubled = v.capacity() * 2;
+		v.reserve(doubled > v.size() + 1 ? doubled : v.size() + 1);
+	}
+}
+
+} // namespace hana23
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef HANA23_UTILITY_WORK_STEALING_DEQUE_HPP
+#define HANA23_UTILITY_WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace hana23 {
+
+// Chase-Lev deque of pointers (Lê, Pop, Cohen, Zappa Nardelli: "Correct and Efficient Work-Stealing
+// for Weak Memory Models"), owner pushes and pops at the bottom, thieves steal from the top
+
+template <typename T> class _work_stealing_deque {
+	struct ring {
+		const int64_t capacity;
+		const std::unique_ptr<std::atomic<T *>[]> items;
+		// retired rings are kept alive until the deque is destroyed as thieves can still read them
+		std::unique_ptr<ring> previous;
+
+		explicit ring(int64_t cap, std::unique_ptr<ring> prev = nullptr): capacity{cap}, items{new std::atomic<T *>[static_cast<size_t>(cap)]}, previous{std::move(prev)} { }
+
+		T * get(int64_t index) const noexcept {
+			return items[static_cast<size_t>(index & (capacity - 1))].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t index, T * value) noexcept {
+			items[static_cast<size_t>(index & (capacity - 1))].store(value, std::memory_order_relaxed);
+		}
+	};
+
+	alignas(64) std::atomic<int64_t> top{0};
+	alignas(64) std::atomic<int64_t> bottom{0};
+	std::atomic<ring *> buffer;
+	std::unique_ptr<ring> owner;
+
+	ring * grow(ring * current, int64_t b, int64_t t) {
+		auto bigger = std::make_unique<ring>(current->capacity * 2, std::move(owner));
+		for (int64_t i = t; i != b; ++i) {
+			bigger->put(i, current->get(i));
+		}
+		owner = std::move(bigger);
+		buffer.store(owner.get(), std::memory_order_release);
+		return owner.get();
+	}
+
+public:
+	explicit _work_stealing_deque(int64_t capacity = 256): owner{std::make_unique<ring>(capacity)} {
+		buffer.store(owner.get(), std::memory_order_relaxed);
+	}
+
+	_work_stealing_deque(const _work_stealing_deque &) = delete;
+	_work_stealing_deque & operator=(const _work_stealing_deque &) = delete;
+
+	// owner only
+	void push(T * value) {
+		const int64_t b = bottom.load(std::memory_order_relaxed);
+		const int64_t t = top.load(std::memory_order_acquire);
+		ring * r = buffer.load(std::memory_order_relaxed);
+
+		if (b - t > r->capacity - 1) {
+			r = grow(r, b, t);
+		}
+
+		r->put(b, value);
+		// publishes the item (and the object it points to) to thieves
+		bottom.store(b + 1, std::memory_order_release);
+	}
+
+	// owner only
+	T * pop() noexcept {
+		const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		ring * r = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		// restoring bottom needs to be release too, otherwise thieves reading it won't see pushed items
+		if (t > b) {
+			bottom.store(b + 1, std::memory_order_release);
+			return nullptr;
+		}
+
+		T * result = r->get(b);
+
+		if (t == b) {
+			// last item, race with thieves
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				result = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_release);
+		}
+
+		return result;
+	}
+
+	// any thread, returns nullptr if empty or when it lost a race
+	T * steal() noexcept {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b) {
+			return nullptr;
+		}
+
+		T * result = buffer.load(std::memory_order_acquire)->get(t);
+
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+
+		return result;
+	}
+
+	// approximate
+	bool empty() const noexcept {
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+};
+
+} // namespace hana23
+
+#endif
@@ -1,5 +1,48 @@
+#include <hana23/actor.hpp>
+#include <hana23/async_logger.hpp>
+#include <hana23/atomic_function.hpp>
+#include <hana23/batch_executor.hpp>
+#include <hana23/bind.hpp>
+#include <hana23/callback_registry.hpp>
+#include <hana23/command_buffer.hpp>
+#include <hana23/deferred_deleter.hpp>
+#ifdef __linux__
+#include <hana23/event_loop.hpp>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && defined(__x86_64__)
+#include <hana23/fiber_scheduler.hpp>
+#endif
+#include <hana23/function_map.hpp>
+#include <hana23/function_vector.hpp>
+#include <hana23/future.hpp>
+#include <hana23/generator_fn.hpp>
+#include <hana23/job_graph.hpp>
+#include <hana23/lazy.hpp>
+#include <hana23/memoized_function.hpp>
 #include <hana23/move_only_function.hpp>
+#include <hana23/pipe.hpp>
+#include <hana23/pipeline.hpp>
+#include <hana23/priority_executor.hpp>
+#include <hana23/signal.hpp>
+#include <hana23/strand.hpp>
+#include <hana23/task.hpp>
+#include <hana23/task_group.hpp>
+#include <hana23/timer_wheel.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <cassert>
 #include <cstdio>
 
 struct foo {
@@ -7,6 +50,792 @@ struct foo {
 	int b() { return 2; }
 };
 
+static void test_priority_executor() {
+	hana23::priority_executor<3> ex;
+	std::string order;
+
+	const auto now = hana23::priority_executor<3>::clock::now();
+
+	ex.post([&] { order += 'd'; });
+	ex.post(1, now + std::chrono::seconds(2), [&] { order += 'c'; });
+	ex.post(1, now + std::chrono::seconds(1), [&, big = std::array<char, 64>{'b'}] { order += big[0]; });
+	ex.post(0, hana23::move_only_function<void() &&>([&] { order += 'a'; }));
+
+	assert(ex.poll() == 4);
+	assert(order == "abcd");
+	printf("priority_executor: %s\n", order.c_str());
+}
+
+static void test_strand() {
+	hana23::priority_executor<> ex;
+	hana23::strand s{ex};
+	std::string order;
+
+	s.post([&] {
+		order += 'a';
+		// posted from inside the strand, must run after currently running task
+		s.post([&] { order += 'c'; });
+	});
+	s.post([&] { order += 'b'; });
+
+	ex.poll();
+	assert(order == "abc");
+
+	// the strand can be destroyed as soon as its last task did its work, the destructor waits for
+	// the activation to leave
+	hana23::thread_pool pool{2};
+	std::atomic<bool> finished{false};
+	auto pooled = std::make_unique<hana23::strand<hana23::thread_pool>>(pool);
+
+	pooled->post([&] {
+		finished = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	});
+	while (!finished) {
+		std::this_thread::yield();
+	}
+	pooled.reset();
+
+	hana23::strand counted{pool};
+	int count = 0;
+	for (int i = 0; i != 100; ++i) {
+		counted.post([&count] { ++count; });
+	}
+	counted.wait_idle();
+	assert(count == 100);
+
+	printf("strand: %s\n", order.c_str());
+}
+
+static void test_actor() {
+	hana23::priority_executor<> ex;
+	hana23::actor<std::string, hana23::priority_executor<>, 2> a{ex, 4, "x"};
+
+	for (char c: std::string_view{"abc"}) {
+		a.send([c](std::string & state) { state += c; });
+	}
+	a.send([](std::string & state) {
+		assert(state == "xabc");
+		printf("actor: %s\n", state.c_str());
+	});
+
+	// batch of two messages per activation
+	assert(ex.poll() == 2);
+
+	hana23::thread_pool pool{2};
+	std::atomic<bool> finished{false};
+	auto pooled = std::make_unique<hana23::actor<int, hana23::thread_pool>>(pool, 4, 0);
+
+	pooled->send([&](int &) {
+		finished = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	});
+	while (!finished) {
+		std::this_thread::yield();
+	}
+	pooled.reset();
+}
+
+static unsigned fib(hana23::thread_pool & pool, unsigned n) {
+	if (n < 2) {
+		return n;
+	}
+
+	unsigned a = 0;
+	hana23::task_group group{pool};
+	group.run([&] { a = fib(pool, n - 1); });
+	const unsigned b = fib(pool, n - 2);
+	group.wait();
+
+	return a + b;
+}
+
+static void test_task_group() {
+	hana23::thread_pool pool{2};
+	const unsigned result = fib(pool, 20);
+
+	assert(result == 6765);
+	printf("task_group: fib(20) = %u\n", result);
+
+	hana23::task_group group{pool};
+	group.run([] { throw 42; });
+
+	try {
+		group.wait();
+		assert(false);
+	} catch (int ex) {
+		assert(ex == 42);
+	}
+}
+
+static void test_job_graph() {
+	hana23::thread_pool pool{2};
+	hana23::job_graph graph;
+	std::atomic<int> value{0};
+
+	// diamond: a -> (b, c) -> d
+	const auto a = graph.add([&] { value = 1; });
+	const auto b = graph.add([&] { value += 10; });
+	const auto c = graph.add([&] { value += 100; });
+	const auto d = graph.add([&] { value = value * 2; });
+
+	graph.precede(a, b);
+	graph.precede(a, c);
+	graph.precede(b, d);
+	graph.precede(c, d);
+
+	for (int i = 0; i != 3; ++i) {
+		graph.run(pool);
+		assert(value == 222);
+	}
+	const int result = value;
+
+	// d -> a closes a cycle, nothing runs
+	graph.precede(d, a);
+	value = 0;
+	try {
+		graph.run(pool);
+		assert(false);
+	} catch (const std::logic_error &) { }
+	assert(value == 0);
+
+	printf("job_graph: %d\n", result);
+}
+
+static void test_timer_wheel() {
+	hana23::timer_wheel wheel;
+	std::string fired;
+
+	wheel.schedule_after(10, [&] { fired += 'a'; });
+	const auto cancelled = wheel.schedule_after(20, [&] { fired += 'x'; });
+	wheel.schedule_after(5000, [&] { fired += 'b'; });
+
+	assert(wheel.cancel(cancelled));
+	assert(!wheel.cancel(cancelled));
+
+	assert(wheel.advance(9) == 0);
+	assert(wheel.advance(1) == 1);
+	assert(wheel.advance_to(5000) == 1);
+	assert(fired == "ab" && wheel.empty());
+	printf("timer_wheel: %s\n", fired.c_str());
+}
+
+#ifdef __linux__
+static void test_event_loop() {
+	hana23::event_loop loop;
+	int fds[2];
+	assert(pipe(fds) == 0);
+
+	// a handler of a connection ([this, fd, buffer]) is stored inline
+	char scratch[4];
+	auto connection_handler = [&loop, fd = fds[1], buffer = &scratch[0]](int) { loop.stop(); (void)fd; (void)buffer; };
+	static_assert(hana23::event_loop::handler_type::is_inline<decltype(connection_handler)>);
+	loop.on_writable(fds[1], std::move(connection_handler));
+	loop.remove(fds[1]);
+
+	std::string received;
+	loop.on_readable(fds[0], [&](int) {
+		char buffer[16];
+		const auto n = read(fds[0], buffer, sizeof(buffer));
+		received.append(buffer, static_cast<size_t>(n));
+		loop.remove(fds[0]);
+		loop.stop();
+	});
+
+	std::thread writer([&] {
+		loop.post([&] { assert(write(fds[1], "ping", 4) == 4); });
+	});
+
+	loop.run();
+	writer.join();
+
+	loop.schedule_after(std::chrono::milliseconds(1), [&] {
+		received += '!';
+		loop.stop();
+	});
+	loop.run();
+
+	assert(received == "ping!");
+	printf("event_loop: %s\n", received.c_str());
+
+	// every post must wake the loop, otherwise run_once blocks forever
+	constexpr int posts = 20000;
+	int executed = 0;
+
+	std::thread poster([&] {
+		for (int i = 0; i != posts; ++i) {
+			loop.post([&executed] { ++executed; });
+		}
+	});
+
+	while (executed != posts) {
+		loop.run_once();
+	}
+	poster.join();
+
+	close(fds[0]);
+	close(fds[1]);
+}
+#endif
+
+static hana23::task<int> square(hana23::thread_pool & pool, int x) {
+	co_await hana23::schedule_on(pool);
+	co_return x * x;
+}
+
+static hana23::task<int> sum_of_squares(hana23::thread_pool & pool, int n) {
+	int result = 0;
+	for (int i = 1; i <= n; ++i) {
+		result += co_await square(pool, i);
+	}
+	co_return result;
+}
+
+static void test_task() {
+	hana23::thread_pool pool{2};
+	const int result = hana23::sync_wait(sum_of_squares(pool, 10));
+
+	assert(result == 385);
+	printf("task: %d\n", result);
+}
+
+// forwards to the pool, counting task nodes allocated for posted callables
+template <bool Intrusive> struct counting_executor {
+	hana23::thread_pool & pool;
+	std::atomic<int> allocations{0};
+
+	template <typename F> void post(F && f) {
+		++allocations;
+		pool.post(std::forward<F>(f));
+	}
+
+	using node_type = hana23::thread_pool::node_type;
+
+	void post_node(node_type & n) requires Intrusive {
+		pool.post_node(n);
+	}
+};
+
+template <typename Executor> static hana23::task<int> hop(Executor & ex, int count) {
+	for (int i = 0; i != count; ++i) {
+		co_await hana23::schedule_on(ex);
+	}
+	co_return count;
+}
+
+static void test_schedule_on() {
+	hana23::thread_pool pool{2};
+
+	counting_executor<true> intrusive{pool};
+	assert(hana23::sync_wait(hop(intrusive, 1000)) == 1000);
+	assert(intrusive.allocations == 0);
+
+	counting_executor<false> plain{pool};
+	assert(hana23::sync_wait(hop(plain, 1000)) == 1000);
+	assert(plain.allocations == 1000);
+
+	hana23::strand<hana23::thread_pool> s{pool};
+	assert(hana23::sync_wait(hop(s, 1000)) == 1000);
+
+	printf("schedule_on: %d allocations per 1000 hops\n", intrusive.allocations.load());
+}
+
+static void test_future() {
+	hana23::thread_pool pool{2};
+	hana23::promise<int> p;
+	hana23::future<int> f = p.get_future();
+
+	std::atomic<int> result{0};
+	std::move(f).then([&](int value) { result = value * 2; });
+	pool.post([p = std::move(p)]() mutable { p.set_value(21); });
+
+	hana23::future<int> broken = hana23::promise<int>{}.get_future();
+
+	try {
+		std::move(broken).get();
+		assert(false);
+	} catch (const std::future_error & e) {
+		assert(e.code() == std::future_errc::broken_promise);
+	}
+
+	while (result == 0) {
+		std::this_thread::yield();
+	}
+
+	assert(result == 42);
+
+	// every place the value was constructed at (starting in the shared state) was aligned
+	struct alignas(64) aligned_value {
+		int value;
+		bool aligned;
+
+		explicit aligned_value(int v) noexcept: value{v}, aligned{is_aligned(this)} { }
+		aligned_value(aligned_value && other) noexcept: value{other.value}, aligned{other.aligned && is_aligned(this)} { }
+
+		// through volatile, otherwise the compiler assumes the alignment of the type
+		static bool is_aligned(const void * address) noexcept {
+			const volatile uintptr_t value = reinterpret_cast<uintptr_t>(address);
+			return value % 64 == 0;
+		}
+	};
+
+	// on a new thread with several states alive at once, so they don't come from a lucky cached block
+	std::thread{[] {
+		std::vector<hana23::promise<aligned_value>> promises(8);
+		std::vector<hana23::future<aligned_value>> futures;
+		for (auto & q: promises) {
+			futures.push_back(q.get_future());
+		}
+
+		for (int i = 0; i != 8; ++i) {
+			promises[static_cast<size_t>(i)].set_value(i);
+
+			const aligned_value v = std::move(futures[static_cast<size_t>(i)]).get();
+			assert(v.value == i && v.aligned);
+		}
+	}}.join();
+
+	printf("future: %d\n", result.load());
+}
+
+static void test_pipe() {
+	auto increment = [](int x) { return x + 1; };
+	auto twice = [](int x) { return x * 2; };
+
+	auto chain = hana23::pipe(increment, twice).then([](int x) { return std::to_string(x); });
+	static_assert(hana23::_move_only_function_sbo_compatible<decltype(chain)>, "stateless chain doesn't allocate");
+
+	hana23::move_only_function<std::string(int) &&> f = std::move(chain);
+	const std::string result = std::move(f)(3);
+
+	assert(result == "8");
+	assert(hana23::compose(increment, twice)(3) == 7);
+	printf("pipe: %s\n", result.c_str());
+}
+
+static int subtract(int a, int b) {
+	return a - b;
+}
+
+static void test_bind() {
+	struct accumulator {
+		int total = 0;
+
+		int add(int x) {
+			return total += x;
+		}
+	} acc;
+
+	auto add = hana23::bind_front<int(int), &accumulator::add>(&acc);
+	// the bound state is what goes to the buffer, sizeof(move_only_function) is fixed anyway
+	using bound_method = hana23::_bound<hana23::_bind_side::front, hana23::_constant_callable<&accumulator::add>, accumulator *>;
+	static_assert(hana23::_move_only_function_sbo_compatible<bound_method>);
+	static_assert(!hana23::_move_only_function_sbo_compatible<hana23::_bound<hana23::_bind_side::front, int (accumulator::*)(int), accumulator *>>);
+
+	add(2);
+	assert(add(3) == 5);
+	assert(hana23::bind_front<int(int)>(subtract, 10)(3) == 7);
+	assert(hana23::bind_back<int(int)>(subtract, 10)(3) == -7);
+	printf("bind: %d\n", acc.total);
+}
+
+static void test_function_vector() {
+	hana23::function_vector<void(std::string &)> middleware;
+
+	middleware.push_back([](std::string & out) { out += "a"; });
+	middleware.push_back([suffix = std::string(32, 'b')](std::string & out) { out += suffix.substr(0, 1); });
+	middleware.push_back([](std::string & out) { out += "c"; });
+	middleware.erase(0);
+
+	std::string result;
+	middleware.for_each_invoke(result);
+	middleware.invoke(1, result);
+
+	assert(middleware.size() == 2 && result == "bcc");
+	printf("function_vector: %s\n", result.c_str());
+}
+
+static void test_command_buffers() {
+	hana23::command_buffers<void(std::vector<int> &)> commands;
+	std::vector<std::thread> workers;
+
+	for (int t = 0; t != 2; ++t) {
+		workers.emplace_back([&commands, t] {
+			for (int i = 0; i != 3; ++i) {
+				commands.record([value = t * 10 + i](std::vector<int> & out) { out.push_back(value); });
+			}
+		});
+	}
+
+	for (auto & worker: workers) {
+		worker.join();
+	}
+
+	std::vector<int> result;
+	commands.replay(result);
+
+	// order within each thread is kept
+	assert(result.size() == 6 && commands.size() == 0);
+	assert(std::is_sorted(result.begin(), result.begin() + 3) && std::is_sorted(result.begin() + 3, result.end()));
+
+	// reset destroys commands which weren't replayed, also after a replay emptied the buffer once
+	hana23::command_buffer<void(std::vector<int> &)> single;
+	auto owned = std::make_shared<int>(7);
+	std::vector<int> replayed;
+	single.record([owned](std::vector<int> & out) { out.push_back(*owned); });
+	single.replay(replayed);
+	single.record([](std::vector<int> & out) { out.push_back(0); });
+	single.record([owned](std::vector<int> & out) { out.push_back(*owned); });
+	assert(owned.use_count() == 2);
+	single.reset();
+	assert(owned.use_count() == 1 && single.empty() && replayed == std::vector<int>{7});
+
+	printf("command_buffers: %zu commands\n", result.size());
+}
+
+static void test_batch_executor() {
+	hana23::batch_executor ex;
+	std::string order;
+
+	for (char c: std::string_view{"abc"}) {
+		ex.post([&order, c] { order += c; });
+		ex.post([&order, c] { order += static_cast<char>(c - 'a' + 'A'); });
+	}
+
+	// tasks of one type run together in order of posting
+	assert(ex.run() == 6 && ex.empty());
+	assert(order == "abcABC");
+	printf("batch_executor: %s\n", order.c_str());
+}
+
+static void test_signal() {
+	hana23::signal<void(int)> changed;
+	std::atomic<int> total{0};
+
+	const auto first = changed.connect([&](int x) { total += x; });
+	changed.connect([&](int x) { total += 10 * x; });
+
+	std::thread emitter{[&] {
+		for (int i = 0; i != 100; ++i) {
+			changed(1);
+		}
+	}};
+
+	emitter.join();
+	assert(total == 1100);
+
+	assert(changed.disconnect(first) && !changed.disconnect(first));
+	changed(1);
+
+	assert(total == 1110 && changed.size() == 1);
+
+	// rvalue reference parameters are forwarded
+	hana23::signal<void(std::string &&)> moved;
+	std::string received;
+	moved.connect([&received](std::string && text) { received = std::move(text); });
+	moved(std::string(32, 'x'));
+	assert(received == std::string(32, 'x'));
+
+	// a slot's captures can retire through the epoch domain when the slot is reclaimed
+	struct scoped_connection {
+		hana23::signal<void(int)> * target;
+		hana23::signal<void(int)>::connection id;
+
+		scoped_connection(hana23::signal<void(int)> * t, hana23::signal<void(int)>::connection c) noexcept: target{t}, id{c} { }
+		scoped_connection(scoped_connection && other) noexcept: target{std::exchange(other.target, nullptr)}, id{other.id} { }
+
+		~scoped_connection() {
+			if (target) {
+				target->disconnect(id);
+			}
+		}
+	};
+
+	hana23::signal<void(int)> inner;
+	const auto nested = changed.connect([scope = scoped_connection{&inner, inner.connect([](int) { })}](int) { });
+	assert(changed.disconnect(nested) && inner.empty());
+
+	printf("signal: %d\n", total.load());
+}
+
+static void test_callback_registry() {
+	hana23::callback_registry<void(int &)> registry;
+
+	const auto a = registry.insert([](int & x) { x += 1; });
+	const auto b = registry.insert([](int & x) { x += 10; });
+	const auto c = registry.insert([](int & x) { x += 100; });
+
+	assert(registry.erase(a) && !registry.erase(a) && !registry.contains(a));
+
+	// reused slot gets a new generation
+	const auto d = registry.insert([](int & x) { x += 1000; });
+	assert(d.index == a.index && d != a && registry.contains(b) && registry.contains(c));
+
+	int total = 0;
+	registry.broadcast(total);
+	assert(total == 1110 && registry.size() == 3);
+	printf("callback_registry: %d\n", total);
+}
+
+static void test_function_map() {
+	hana23::function_map<uint32_t, void(std::string &)> router;
+
+	for (uint32_t id = 0; id != 100; ++id) {
+		router.insert(id, [id](std::string & out) { out += std::to_string(id) + ";"; });
+	}
+
+	assert(!router.insert(7, [](std::string &) { }));
+	assert(router.erase(42) && !router.erase(42));
+
+	std::string out;
+	assert(router.dispatch(7, out) && !router.dispatch(42, out) && router.dispatch(99, out));
+	assert(out == "7;99;" && router.size() == 99);
+	printf("function_map: %s\n", out.c_str());
+}
+
+static void test_atomic_function() {
+	hana23::atomic_function<int(int)> handler{[](int x) { return x + 1; }};
+	std::atomic<bool> stop{false};
+
+	std::thread reader{[&] {
+		while (!stop) {
+			const int result = handler(1);
+			assert(result == 2 || result == 3);
+		}
+	}};
+
+	handler.store([](int x) { return x + 2; });
+	stop = true;
+	reader.join();
+
+	assert(handler(1) == 3);
+	printf("atomic_function: %d\n", handler(1));
+}
+
+static void test_deferred_deleter() {
+	struct tracker {
+		std::atomic<std::thread::id> * destroyed_on;
+		std::string payload = std::string(256, 'x');
+
+		explicit tracker(std::atomic<std::thread::id> * where): destroyed_on{where} { }
+		tracker(tracker && other) noexcept: destroyed_on{std::exchange(other.destroyed_on, nullptr)}, payload{std::move(other.payload)} { }
+		~tracker() {
+			if (destroyed_on) {
+				destroyed_on->store(std::this_thread::get_id());
+			}
+		}
+
+		void operator()() const { }
+	};
+
+	std::atomic<std::thread::id> destroyed_on{};
+	hana23::deferred_deleter deleter{8};
+
+	{
+		hana23::deferred_deleter::scope scope{deleter};
+		hana23::move_only_function<void()> f{tracker{&destroyed_on}};
+	}
+
+	while (destroyed_on.load() == std::thread::id{}) {
+		std::this_thread::yield();
+	}
+	assert(destroyed_on.load() != std::this_thread::get_id());
+
+	// outside of scope destruction is inline
+	{
+		hana23::move_only_function<void()> f{tracker{&destroyed_on}};
+	}
+	assert(destroyed_on.load() == std::this_thread::get_id());
+
+	printf("deferred_deleter: ok\n");
+}
+
+static void test_lazy() {
+	std::atomic<int> runs{0};
+	hana23::lazy<std::string> config{[&runs] {
+		++runs;
+		return std::string{"port=8080"};
+	}};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i != 4; ++i) {
+		readers.emplace_back([&] { assert(*config == "port=8080"); });
+	}
+	for (std::thread & t: readers) {
+		t.join();
+	}
+
+	assert(runs == 1 && config.initialized());
+
+	hana23::once_function<void(int)> warmup{[&runs](int n) { runs += n; }};
+	assert(warmup(10) && !warmup(10) && warmup.called());
+	assert(runs == 11);
+
+	int attempts = 0;
+	hana23::once_function<void()> failing{[&attempts] {
+		++attempts;
+		throw std::runtime_error{"failed"};
+	}};
+	for (int i = 0; i != 2; ++i) {
+		try {
+			failing();
+			assert(false);
+		} catch (const std::runtime_error &) { }
+	}
+	assert(attempts == 1 && failing.called() && failing.failed());
+
+	hana23::lazy<std::string> broken{[&attempts]() -> std::string {
+		++attempts;
+		throw std::runtime_error{"failed"};
+	}};
+	for (int i = 0; i != 2; ++i) {
+		try {
+			broken.get();
+			assert(false);
+		} catch (const std::runtime_error &) { }
+	}
+	assert(attempts == 2 && broken.failed() && !broken.initialized());
+
+	printf("lazy: %s\n", config->c_str());
+}
+
+static void test_memoized_function() {
+	int calls = 0;
+	hana23::memoized_function<double(int, const std::string &) const> price{[&calls](int quantity, const std::string & symbol) {
+		++calls;
+		return quantity * 1.5 + static_cast<double>(symbol.size());
+	}};
+
+	assert(price(2, "ab") == 5.0 && price(2, "ab") == 5.0 && calls == 1);
+	assert(price(3, "ab") == 6.5 && calls == 2);
+
+	price.clear();
+	assert(price(2, "ab") == 5.0 && calls == 3);
+
+	printf("memoized_function: %d calls\n", calls);
+}
+
+static void test_async_logger() {
+	std::string written;
+
+	{
+		hana23::async_logger logger{[&written](std::string_view text) { written += text; }};
+		const std::thread::id caller = std::this_thread::get_id();
+
+		for (int i = 0; i != 3; ++i) {
+			logger.log([i, caller](std::string & out) {
+				assert(std::this_thread::get_id() != caller);
+				out += "tick ";
+				out += std::to_string(i);
+			});
+		}
+
+		logger.flush();
+		assert(written == "tick 0\ntick 1\ntick 2\n");
+	}
+
+	printf("async_logger: %zu bytes\n", written.size());
+}
+
+static void test_generator_fn() {
+	int next = 0;
+	hana23::generator_fn<int> counter{[&next]() -> std::optional<int> {
+		if (next == 1000) {
+			return std::nullopt;
+		}
+		return next++;
+	}};
+
+	std::array<int, 256> batch{};
+	long sum = 0;
+	size_t batches = 0;
+
+	while (const size_t n = counter.next_batch(batch)) {
+		for (size_t i = 0; i != n; ++i) {
+			sum += batch[i];
+		}
+		++batches;
+	}
+
+	assert(sum == 999 * 1000 / 2 && batches == 4);
+
+	int remaining = 3;
+	hana23::generator_fn<std::string> words{[&remaining](std::span<std::string> out) {
+		size_t count = 0;
+		while (count != out.size() && remaining != 0) {
+			out[count++] = std::to_string(remaining--);
+		}
+		return count;
+	}};
+
+	std::string joined;
+	while (std::optional<std::string> word = words.next()) {
+		joined += *word;
+	}
+
+	assert(joined == "321");
+	printf("generator_fn: %ld in %zu batches, %s\n", sum, batches, joined.c_str());
+}
+
+static void test_pipeline() {
+	long sum = 0;
+	size_t lines = 0;
+
+	auto numbers = hana23::pipeline_builder<int>{16, 4}
+	                   .stage<int>([](int && x, hana23::emitter<int> & emit) {
+		                   if (x % 3 == 0) {
+			                   emit(x * 2);
+		                   }
+	                   })
+	                   .stage<std::string>([](int && x, hana23::emitter<std::string> & emit) { emit(std::to_string(x)); })
+	                   .sink([&](std::string && line) {
+		                   sum += std::stol(line);
+		                   ++lines;
+	                   });
+
+	for (int i = 0; i != 1000; ++i) {
+		numbers.push(i);
+	}
+	numbers.wait();
+
+	// 0, 3, ..., 999 doubled
+	assert(lines == 334 && sum == 2 * 3 * (333 * 334 / 2));
+
+	hana23::thread_pool pool{2};
+	long pooled = 0;
+
+	{
+		auto doubled = hana23::pipeline_builder<long>{}.stage<long>([](long && x, hana23::emitter<long> & emit) { emit(2 * x); }).sink([&pooled](long && x) { pooled += x; }, pool);
+
+		for (long i = 1; i <= 100; ++i) {
+			doubled.push(i);
+		}
+		doubled.wait();
+	}
+
+	assert(pooled == 10100);
+	printf("pipeline: %ld %ld\n", sum, pooled);
+}
+
+#if defined(__linux__) && defined(__x86_64__)
+static void test_fiber_scheduler() {
+	hana23::fiber_scheduler scheduler;
+	std::string order;
+
+	for (char c: std::string_view{"ab"}) {
+		scheduler.spawn([&, c] {
+			order += c;
+			scheduler.yield();
+			order += static_cast<char>(c - 'a' + 'A');
+		});
+	}
+
+	scheduler.run();
+	assert(order == "abAB" && scheduler.size() == 0);
+	printf("fiber_scheduler: %s\n", order.c_str());
+}
+#endif
+
 int main() {
 	hana23::move_only_function<int(void)> f = [i = 0ull]() mutable {
 		printf("this = %p, value = %llu\n", &i, i);
@@ -24,4 +853,35 @@ int main() {
 	hana23::move_only_function<int(foo)> f2 = p;
 
 	printf("%d\n", f2(foo()));
+
+	test_priority_executor();
+	test_strand();
+	test_actor();
+	test_task_group();
+	test_job_graph();
+	test_timer_wheel();
+	test_task();
+	test_schedule_on();
+	test_future();
+	test_pipe();
+	test_bind();
+	test_function_vector();
+	test_command_buffers();
+	test_batch_executor();
+	test_signal();
+	test_callback_registry();
+	test_function_map();
+	test_atomic_function();
+	test_deferred_deleter();
+	test_lazy();
+	test_memoized_function();
+	test_async_logger();
+	test_generator_fn();
+	test_pipeline();
+#ifdef __linux__
+	test_event_loop();
+#endif
+#if defined(__linux__) && defined(__x86_64__)
+	test_fiber_scheduler();
+#endif
 }
\ No newline at end of file